@@ -0,0 +1,323 @@
+// Measures how the cost of building a parser scales with its size. For each
+// size, a program with that many flags is generated for the legacy header
+// (once as a group of flags, and once as an option_set and a command_set
+// with that many options each) and for flags.hpp, and compiled to an object
+// file. The compile time, the peak memory used by the compiler, and the size
+// of the generated code are written as JSON, so that regressions in template
+// instantiation can be caught by comparing runs.
+//
+// Usage: bench_compile_scaling [output.json] [sizes...]
+//
+// The default sizes are 10, 100, and 1000. Results are written to stdout if
+// no output file is given.
+#include "compile_scaling_config.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <elf.h>
+#include <iterator>
+#include <spawn.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <vector>
+
+extern char** environ;
+
+struct measurement {
+    bool ok = false;
+    double compile_seconds = 0;
+    long peak_memory_kib = 0;
+    long text_bytes = -1;
+};
+
+// Writes a program which parses argv with a legacy parser containing the
+// given number of long flags
+std::string generate_legacy(int num_flags) {
+    std::string source =
+        "#include <arglet/arglet.hpp>\n"
+        "\n"
+        "int main(int argc, char const** argv) {\n"
+        "    using namespace arglet;\n"
+        "    auto parser = sequence {\n"
+        "        ignore_arg,\n"
+        "        group {\n";
+    for (int i = 0; i < num_flags; i++) {
+        std::string n = std::to_string(i);
+        source += "            flag {tag<" + n + ">(), \"--flag-" + n + "\"}";
+        source += i + 1 < num_flags ? ",\n" : "}};\n";
+    }
+    source += "    parser.parse(argc, argv);\n"
+              "    return parser[tag<0>()] + parser[tag<"
+              + std::to_string(num_flags - 1) + ">()];\n}\n";
+    return source;
+}
+
+// Writes a program which parses argv with a legacy option_set and command_set,
+// each with the given number of options. Their options are held in a
+// type_array, and looked up through partial_tuple, so this measures the cost
+// of instantiating those for large sets
+std::string generate_legacy_sets(int num_flags) {
+    std::string source =
+        "#include <arglet/arglet.hpp>\n"
+        "\n"
+        "int run(int, char const**) { return 0; }\n"
+        "\n"
+        "int main(int argc, char const** argv) {\n"
+        "    using namespace arglet;\n"
+        "    auto parser = sequence {\n"
+        "        ignore_arg,\n"
+        "        group {option_set {\n"
+        "            tag<0>(),\n"
+        "            0,\n";
+    for (int i = 0; i < num_flags; i++) {
+        std::string n = std::to_string(i);
+        source += "            option {\"--level=" + n + "\", " + n + "}";
+        source += i + 1 < num_flags ? ",\n" : "}},\n";
+    }
+    source += "        command_set {\n"
+              "            tag<1>(),\n"
+              "            nullptr,\n";
+    for (int i = 0; i < num_flags; i++) {
+        std::string n = std::to_string(i);
+        source += "            option {\"command-" + n + "\", run}";
+        source += i + 1 < num_flags ? ",\n" : "}};\n";
+    }
+    source += "    parser.parse(argc, argv);\n"
+              "    return parser[tag<0>()] + parser[tag<1>()](argc, argv);\n"
+              "}\n";
+    return source;
+}
+
+// Writes a program which looks up argv[1] in the flag maps made from a tuple
+// with the given number of flag args
+std::string generate_flags(int num_flags) {
+    std::string source =
+        "#include <arglet/flags.hpp>\n"
+        "\n"
+        "using namespace arglet::flags;\n"
+        "using short_flags = std::array<char, 1>;\n"
+        "using no_short_flags = std::array<char, 0>;\n"
+        "using long_flags = std::array<string_view, 1>;\n"
+        "\n"
+        "constexpr tuplet::tuple flags {\n";
+    // Short flags are printable characters. There are only 94 of them, so
+    // flags after the first 94 are long only, and every key is unique
+    constexpr int num_short = 94;
+    for (int i = 0; i < num_flags; i++) {
+        std::string n = std::to_string(i);
+        std::string shorts = i < num_short
+                                 ? "short_flags {char("
+                                       + std::to_string(33 + i) + ")}"
+                                 : "no_short_flags {}";
+        source += "    flag_arg {" + shorts + ", long_flags {\"--flag-" + n
+                  + "\"}}";
+        source += i + 1 < num_flags ? ",\n" : "};\n";
+    }
+    source += "\n"
+              "int main(int argc, char const** argv) {\n"
+              "    auto long_map = make_long_flag_map(flags);\n"
+              "    auto short_map = make_short_flag_map(flags);\n"
+              "    if (argc < 2) {\n"
+              "        return 0;\n"
+              "    }\n"
+              "    return int(long_map.lower_bound(argv[1])\n"
+              "               + short_map.lower_bound(argv[1][0]));\n"
+              "}\n";
+    return source;
+}
+
+bool write_file(std::string const& path, std::string const& contents) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    fwrite(contents.data(), 1, contents.size(), file);
+    return fclose(file) == 0;
+}
+
+// Returns the total size of every .text section in an ELF object file, or -1
+// if the file isn't a 64-bit ELF file
+long text_size(std::string const& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return -1;
+    }
+    std::vector<char> data;
+    char buffer[1 << 16];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + count);
+    }
+    fclose(file);
+
+    Elf64_Ehdr header;
+    if (data.size() < sizeof(header)
+        || memcmp(data.data(), ELFMAG, SELFMAG) != 0
+        || data[EI_CLASS] != ELFCLASS64) {
+        return -1;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    size_t table_end =
+        header.e_shoff + size_t(header.e_shnum) * sizeof(Elf64_Shdr);
+    if (header.e_shstrndx >= header.e_shnum || table_end > data.size()) {
+        return -1;
+    }
+    auto section = [&](size_t i) {
+        Elf64_Shdr result;
+        memcpy(
+            &result,
+            data.data() + header.e_shoff + i * sizeof(Elf64_Shdr),
+            sizeof(result));
+        return result;
+    };
+    Elf64_Shdr names = section(header.e_shstrndx);
+
+    long total = 0;
+    for (size_t i = 0; i < header.e_shnum; i++) {
+        Elf64_Shdr s = section(i);
+        if (s.sh_type != SHT_PROGBITS
+            || names.sh_offset + s.sh_name >= data.size()) {
+            continue;
+        }
+        char const* name = data.data() + names.sh_offset + s.sh_name;
+        if (strncmp(name, ".text", 5) == 0) {
+            total += long(s.sh_size);
+        }
+    }
+    return total;
+}
+
+// Compiles the source file to an object file. The peak memory is that of the
+// largest process the compiler driver waited on, which is the compiler proper
+measurement compile(std::string const& source, std::string const& object) {
+    std::vector<std::string> args {compiler};
+    for (char const* flag : compile_flags) {
+        args.push_back(flag);
+    }
+    for (char const* dir : include_dirs) {
+        args.push_back(std::string("-I") + dir);
+    }
+    args.insert(args.end(), {"-c", source, "-o", object});
+
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    measurement result;
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ)
+        != 0) {
+        return result;
+    }
+    int status = 0;
+    rusage usage {};
+    if (wait4(pid, &status, 0, &usage) != pid) {
+        return result;
+    }
+    auto elapsed = clock::now() - start;
+
+    result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    result.compile_seconds = std::chrono::duration<double>(elapsed).count();
+    // ru_maxrss is in kilobytes on Linux, and in bytes on macOS
+#ifdef __APPLE__
+    result.peak_memory_kib = usage.ru_maxrss / 1024;
+#else
+    result.peak_memory_kib = usage.ru_maxrss;
+#endif
+    result.text_bytes = result.ok ? text_size(object) : -1;
+    return result;
+}
+
+int main(int argc, char const** argv) {
+    char const* output_path = argc > 1 ? argv[1] : nullptr;
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; i++) {
+        int size = std::atoi(argv[i]);
+        if (size <= 0) {
+            fprintf(stderr, "Expected a positive number of flags\n");
+            return 1;
+        }
+        sizes.push_back(size);
+    }
+    if (sizes.empty()) {
+        sizes = {10, 100, 1000};
+    }
+
+    struct {
+        char const* name;
+        std::string (*generate)(int);
+    } layers[] {
+        {"legacy", generate_legacy},
+        {"legacy_sets", generate_legacy_sets},
+        {"flags", generate_flags},
+    };
+
+    std::string json = "{\n  \"compiler\": \"" + std::string(compiler)
+                       + "\",\n  \"flags\": \"";
+    for (size_t i = 0; i < std::size(compile_flags); i++) {
+        json += (i ? " " : "") + std::string(compile_flags[i]);
+    }
+    json += "\",\n  \"results\": [";
+
+    bool good = true;
+    char const* separator = "\n";
+    for (auto& layer : layers) {
+        for (int size : sizes) {
+            std::string base = std::string(scratch_dir) + "/" + layer.name
+                               + "_" + std::to_string(size);
+            if (!write_file(base + ".cpp", layer.generate(size))) {
+                fprintf(stderr, "Unable to write %s.cpp\n", base.c_str());
+                return 1;
+            }
+            measurement m = compile(base + ".cpp", base + ".o");
+            if (!m.ok) {
+                fprintf(stderr, "Unable to compile %s.cpp\n", base.c_str());
+                good = false;
+                continue;
+            }
+            fprintf(
+                stderr,
+                "%-11s %6d flags: %8.2f s %10ld KiB %10ld bytes of .text\n",
+                layer.name,
+                size,
+                m.compile_seconds,
+                m.peak_memory_kib,
+                m.text_bytes);
+
+            char entry[256];
+            snprintf(
+                entry,
+                sizeof(entry),
+                "%s    {\"layer\": \"%s\", \"num_flags\": %d, "
+                "\"compile_seconds\": %.3f, \"peak_memory_kib\": %ld, "
+                "\"text_bytes\": %ld}",
+                separator,
+                layer.name,
+                size,
+                m.compile_seconds,
+                m.peak_memory_kib,
+                m.text_bytes);
+            json += entry;
+            separator = ",\n";
+        }
+    }
+    json += "\n  ]\n}\n";
+
+    if (output_path) {
+        if (!write_file(output_path, json)) {
+            fprintf(stderr, "Unable to write %s\n", output_path);
+            return 1;
+        }
+    } else {
+        fwrite(json.data(), 1, json.size(), stdout);
+    }
+    return !good;
+}
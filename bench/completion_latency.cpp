@@ -0,0 +1,84 @@
+// Measures the end-to-end latency of answering a completion request: the time
+// from spawning the process to the process exiting. The latency of spawning
+// `true` is measured as a baseline, since most of the cost is the process
+// itself.
+//
+// Usage: bench_completion_latency [program] [runs]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+// Returns the average time per run in microseconds, or a negative number if
+// the program couldn't be run
+double spawn_latency(char const* const* argv, int runs) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(
+        &actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    for (int i = 0; i < runs; i++) {
+        pid_t pid;
+        if (posix_spawnp(
+                &pid,
+                argv[0],
+                &actions,
+                nullptr,
+                const_cast<char* const*>(argv),
+                environ)
+            != 0) {
+            posix_spawn_file_actions_destroy(&actions);
+            return -1;
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            posix_spawn_file_actions_destroy(&actions);
+            return -1;
+        }
+    }
+    auto elapsed = clock::now() - start;
+    posix_spawn_file_actions_destroy(&actions);
+    return std::chrono::duration<double, std::micro>(elapsed).count() / runs;
+}
+
+int main(int argc, char const** argv) {
+    char const* program = argc > 1 ? argv[1] : COMPLETION_PROGRAM;
+    int runs = argc > 2 ? std::atoi(argv[2]) : 1000;
+    if (runs <= 0) {
+        fprintf(stderr, "Expected a positive number of runs\n");
+        return 1;
+    }
+
+    char const* baseline_argv[] {"true", nullptr};
+    char const* long_argv[] {program, "--arglet-complete", "--co", nullptr};
+    char const* short_argv[] {program, "--arglet-complete", "-", nullptr};
+    char const* command_argv[] {program, "--arglet-complete", "c", nullptr};
+
+    struct {
+        char const* name;
+        char const* const* argv;
+    } cases[] {
+        {"baseline (true)", baseline_argv},
+        {"complete '--co'", long_argv},
+        {"complete '-'", short_argv},
+        {"complete 'c'", command_argv},
+    };
+
+    printf("%-20s %12s\n", "case", "us/process");
+    for (auto& c : cases) {
+        double latency = spawn_latency(c.argv, runs);
+        if (latency < 0) {
+            fprintf(stderr, "Unable to run %s\n", c.argv[0]);
+            return 1;
+        }
+        printf("%-20s %12.1f\n", c.name, latency);
+    }
+}
@@ -0,0 +1,534 @@
+// Compares the cost of parsing the same command lines with the legacy arglet
+// header, with the flag maps from flags.hpp, with a schema built at runtime,
+// and with getopt_long. Every parser recognizes the same options:
+//
+//     -v, --verbose    -q, --quiet    -a, --all    -l, --list
+//     -r, --recursive  --color        -h, --help
+//     -o, --output <file>             -j, --jobs <n>
+//
+// followed by any number of files. For each corpus of command lines, the
+// results of the parsers are checked against each other, and then each
+// parser is timed. The report gives the throughput in tokens per second, the
+// number of instructions retired per token (when hardware counters are
+// available), and the number of allocations per parse.
+//
+// Usage: bench_getopt_comparison [iterations]
+//
+// The benchmark exits with an error if the parsers disagree, so that it can
+// be run as a test with a small number of iterations.
+#include <arglet/arglet.hpp>
+#include <arglet/flags.hpp>
+#include <arglet/schema.hpp>
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using std::string_view;
+
+// Every allocation made through operator new is counted
+static uint64_t num_allocations = 0;
+
+void* operator new(size_t size) {
+    num_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+constexpr size_t num_flags = 7;
+
+// What a command line asked for. Each parser fills one of these
+struct options {
+    std::array<bool, num_flags> flags {};
+    string_view output;
+    int jobs = 0;
+    size_t num_files = 0;
+
+    bool operator==(options const&) const = default;
+};
+
+bool parse_jobs(string_view arg, int& jobs) {
+    auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), jobs);
+    return ec == std::errc() && end == arg.data() + arg.size();
+}
+
+// Parses with getopt_long. The leading '+' stops at the first file rather
+// than permuting argv, which matches how the arglet parsers see the files
+bool parse_getopt(int argc, char** argv, options& result) {
+    constexpr int color = 256;
+    static option const long_options[] {
+        {"verbose", no_argument, nullptr, 'v'},
+        {"quiet", no_argument, nullptr, 'q'},
+        {"all", no_argument, nullptr, 'a'},
+        {"list", no_argument, nullptr, 'l'},
+        {"recursive", no_argument, nullptr, 'r'},
+        {"color", no_argument, nullptr, color},
+        {"help", no_argument, nullptr, 'h'},
+        {"output", required_argument, nullptr, 'o'},
+        {"jobs", required_argument, nullptr, 'j'},
+        {nullptr, 0, nullptr, 0}};
+
+    // Setting optind to 0 makes getopt_long start over
+    optind = 0;
+    opterr = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "+vqalrho:j:", long_options, nullptr))
+           != -1) {
+        switch (c) {
+            case 'v': result.flags[0] = true; break;
+            case 'q': result.flags[1] = true; break;
+            case 'a': result.flags[2] = true; break;
+            case 'l': result.flags[3] = true; break;
+            case 'r': result.flags[4] = true; break;
+            case color: result.flags[5] = true; break;
+            case 'h': result.flags[6] = true; break;
+            case 'o': result.output = optarg; break;
+            case 'j':
+                if (!parse_jobs(optarg, result.jobs)) {
+                    return false;
+                }
+                break;
+            default: return false;
+        }
+    }
+    result.num_files = size_t(argc - optind);
+    return true;
+}
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> quiet;
+constexpr tag<2> all;
+constexpr tag<3> list;
+constexpr tag<4> recursive;
+constexpr tag<5> color;
+constexpr tag<6> help;
+constexpr tag<7> output;
+constexpr tag<8> jobs;
+constexpr tag<9> files;
+} // namespace tags
+
+auto make_legacy_parser() {
+    using namespace arglet;
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {
+                flag {tags::verbose, 'v', "--verbose"},
+                flag {tags::quiet, 'q', "--quiet"},
+                flag {tags::all, 'a', "--all"},
+                flag {tags::list, 'l', "--list"},
+                flag {tags::recursive, 'r', "--recursive"},
+                flag {tags::color, "--color"},
+                flag {tags::help, 'h', "--help"}},
+            value_flag {tags::output, 'o', "--output", string_view()},
+            value_flag {tags::jobs, 'j', "--jobs", 0},
+            item {tags::files, std::vector<string_view>()}}};
+}
+
+// Parses with the legacy header. The parser is made anew for every parse,
+// since that's how it's used in main
+bool parse_legacy(int argc, char const** argv, options& result) {
+    auto parser = make_legacy_parser();
+    if (parser.parse(argc, argv) != argc) {
+        return false;
+    }
+    result.flags = {
+        parser[tags::verbose],
+        parser[tags::quiet],
+        parser[tags::all],
+        parser[tags::list],
+        parser[tags::recursive],
+        parser[tags::color],
+        parser[tags::help]};
+    result.output = parser[tags::output];
+    result.jobs = parser[tags::jobs];
+    result.num_files = parser[tags::files].size();
+    return true;
+}
+
+namespace flag_maps {
+using arglet::flags::flag_spec;
+
+// The first num_flags flag args are flags, and the rest take values
+constexpr static auto flag_args = tuplet::tuple {
+    flag_spec<"-v, --verbose">,
+    flag_spec<"-q, --quiet">,
+    flag_spec<"-a, --all">,
+    flag_spec<"-l, --list">,
+    flag_spec<"-r, --recursive">,
+    flag_spec<"--color">,
+    flag_spec<"-h, --help">,
+    flag_spec<"-o, --output">,
+    flag_spec<"-j, --jobs">};
+constexpr static auto long_map = make_long_flag_map(flag_args);
+constexpr static auto short_map = make_short_flag_map(flag_args);
+
+// Returns the position in flag_args of the flag arg of each entry in a map.
+// It's computed at compile time, so a lookup doesn't scan flag_args
+template <class Map>
+constexpr auto positions_of(Map const& map) {
+    std::array<int, Map::size()> result {};
+    for (size_t i = 0; i < map.size(); i++) {
+        int position = 0;
+        flag_args.for_each([&](auto& arg) {
+            if (&arg == map[i].value.pointer) {
+                result[i] = position;
+            }
+            position++;
+        });
+    }
+    return result;
+}
+constexpr static auto long_positions = positions_of(long_map);
+constexpr static auto short_positions = positions_of(short_map);
+
+// Looks up a flag in one of the maps. Returns the position of its flag arg,
+// or -1 if there's no such flag
+template <class Map, class Positions, class Key>
+int find(Map const& map, Positions const& positions, Key key) {
+    size_t i = map.lower_bound(key);
+    return i < map.size() && map[i].key == key ? positions[i] : -1;
+}
+
+// Applies a flag. Flags which take a value consume the next argument
+bool apply(int i, char const**& arg, char const** end, options& result) {
+    if (i < 0) {
+        return false;
+    }
+    if (size_t(i) < num_flags) {
+        result.flags[i] = true;
+        return true;
+    }
+    if (++arg == end) {
+        return false;
+    }
+    if (size_t(i) == num_flags) {
+        result.output = *arg;
+        return true;
+    }
+    return parse_jobs(*arg, result.jobs);
+}
+} // namespace flag_maps
+
+// Parses with the flag maps from flags.hpp, which is how a program built on
+// the new headers finds its flags
+bool parse_flag_maps(int argc, char const** argv, options& result) {
+    using namespace flag_maps;
+    char const** end = argv + argc;
+    char const** arg = argv + 1;
+    for (; arg != end; ++arg) {
+        string_view token = *arg;
+        if (token.size() < 2 || token[0] != '-') {
+            break;
+        }
+        if (token[1] == '-') {
+            int i = find(long_map, long_positions, token);
+            if (!apply(i, arg, end, result)) {
+                return false;
+            }
+            continue;
+        }
+        for (size_t j = 1; j < token.size(); j++) {
+            int i = find(short_map, short_positions, token[j]);
+            // A flag which takes a value must be the last in the token
+            if (size_t(i) >= num_flags && j + 1 != token.size()) {
+                return false;
+            }
+            if (!apply(i, arg, end, result)) {
+                return false;
+            }
+        }
+    }
+    result.num_files = size_t(end - arg);
+    return true;
+}
+
+// Parses with a schema, which is built the first time it's used, the way a
+// program would register options from its plugins
+bool parse_schema(int argc, char const** argv, options& result) {
+    using arglet::flags::option_kind;
+    using arglet::flags::slot;
+    static arglet::flags::schema const table = [] {
+        arglet::flags::schema s;
+        for (string_view spec :
+             {"-v, --verbose",
+              "-q, --quiet",
+              "-a, --all",
+              "-l, --list",
+              "-r, --recursive",
+              "--color",
+              "-h, --help"}) {
+            s.add(spec);
+        }
+        s.add("-o, --output", option_kind::value);
+        s.add("-j, --jobs", option_kind::value);
+        s.finalize();
+        return s;
+    }();
+
+    std::array<slot, num_flags + 2> slots {};
+    arglet::arg_view args(argc, argv);
+    args.pop();
+    if (!table.parse(args, slots)) {
+        return false;
+    }
+    for (size_t i = 0; i < num_flags; i++) {
+        result.flags[i] = bool(slots[i]);
+    }
+    result.output = slots[num_flags].value;
+    if (slots[num_flags + 1]
+        && !parse_jobs(slots[num_flags + 1].value, result.jobs)) {
+        return false;
+    }
+    result.num_files = args.size();
+    return true;
+}
+
+// A corpus is a set of command lines, each of which starts with the program
+// name
+struct corpus {
+    char const* name;
+    std::vector<std::vector<char const*>> command_lines;
+    size_t num_tokens = 0;
+};
+
+corpus make_corpus(
+    char const* name,
+    std::vector<std::vector<char const*>> lines,
+    size_t repeat) {
+    corpus result {name};
+    for (size_t r = 0; r < repeat; r++) {
+        for (auto& line : lines) {
+            std::vector<char const*> argv {"prog"};
+            argv.insert(argv.end(), line.begin(), line.end());
+            result.num_tokens += argv.size();
+            result.command_lines.push_back(std::move(argv));
+        }
+    }
+    return result;
+}
+
+std::vector<corpus> make_corpora() {
+    std::vector<corpus> corpora;
+    corpora.push_back(make_corpus(
+        "short flags",
+        {{"-v", "-q", "-a"}, {"-l", "-r"}, {"-h"}, {"-a", "-l", "-v", "-r"}},
+        16));
+    corpora.push_back(make_corpus(
+        "combined short flags",
+        {{"-vqa"}, {"-lr", "-h"}, {"-alvr"}, {"-va", "-q"}},
+        16));
+    corpora.push_back(make_corpus(
+        "long flags",
+        {{"--verbose", "--quiet"},
+         {"--all", "--list", "--recursive"},
+         {"--color", "--help"},
+         {"--list", "--color", "--verbose"}},
+        16));
+    corpora.push_back(make_corpus(
+        "values and files",
+        {{"-o", "out.txt", "-j", "8", "a.txt", "b.txt"},
+         {"--output", "build/out", "--jobs", "16", "src"},
+         {"-v", "--jobs", "4", "-o", "x", "1", "2", "3"},
+         {"--color", "-j", "2"}},
+        16));
+    return corpora;
+}
+
+// Counts the instructions retired by this process in user space, if the
+// hardware counters can be read
+class instruction_counter {
+#ifdef __linux__
+    int fd = -1;
+
+   public:
+    instruction_counter() {
+        perf_event_attr attr {};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~instruction_counter() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    bool available() const { return fd >= 0; }
+    void start() {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    uint64_t stop() {
+        uint64_t count = 0;
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+        return count;
+    }
+#else
+   public:
+    bool available() const { return false; }
+    void start() {}
+    uint64_t stop() { return 0; }
+#endif
+};
+
+struct measurement {
+    double tokens_per_second = 0;
+    double instructions_per_token = -1;
+    double allocations_per_parse = 0;
+};
+
+// Parses every command line in the corpus the given number of times. getopt
+// takes char**, so each parser is given a mutable copy of the command lines
+template <class Parse>
+measurement measure(
+    corpus const& c,
+    std::vector<std::vector<char*>>& lines,
+    int iterations,
+    instruction_counter& counter,
+    Parse parse) {
+    using clock = std::chrono::steady_clock;
+    size_t num_failed = 0;
+    uint64_t allocations = num_allocations;
+    counter.start();
+    auto start = clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (auto& line : lines) {
+            options result;
+            num_failed += !parse(int(line.size()), line.data(), result);
+        }
+    }
+    auto elapsed = clock::now() - start;
+    uint64_t instructions = counter.stop();
+    allocations = num_allocations - allocations;
+
+    double total_tokens = double(c.num_tokens) * iterations;
+    double num_parses = double(c.command_lines.size()) * iterations;
+    measurement m;
+    m.tokens_per_second =
+        total_tokens / std::chrono::duration<double>(elapsed).count();
+    if (counter.available()) {
+        m.instructions_per_token = double(instructions) / total_tokens;
+    }
+    m.allocations_per_parse = double(allocations) / num_parses;
+    if (num_failed) {
+        fprintf(stderr, "%s: %zu parses failed\n", c.name, num_failed);
+        m.tokens_per_second = 0;
+    }
+    return m;
+}
+
+int main(int argc, char const** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+    if (iterations <= 0) {
+        fprintf(stderr, "Expected a positive number of iterations\n");
+        return 1;
+    }
+
+    auto legacy = [](int argc, char** argv, options& result) {
+        return parse_legacy(argc, const_cast<char const**>(argv), result);
+    };
+    auto maps = [](int argc, char** argv, options& result) {
+        return parse_flag_maps(argc, const_cast<char const**>(argv), result);
+    };
+    auto schema = [](int argc, char** argv, options& result) {
+        return parse_schema(argc, const_cast<char const**>(argv), result);
+    };
+    struct {
+        char const* name;
+        bool (*parse)(int, char**, options&);
+    } parsers[] {
+        {"arglet (legacy)", legacy},
+        {"arglet (flags.hpp)", maps},
+        {"arglet (schema.hpp)", schema},
+        {"getopt_long", parse_getopt},
+    };
+
+    instruction_counter counter;
+    bool good = true;
+    printf(
+        "%-22s %-20s %14s %14s %14s\n",
+        "corpus",
+        "parser",
+        "Mtokens/s",
+        "instr/token",
+        "allocs/parse");
+    for (corpus const& c : make_corpora()) {
+        std::vector<std::vector<char*>> lines;
+        for (auto& line : c.command_lines) {
+            lines.emplace_back();
+            for (char const* arg : line) {
+                lines.back().push_back(const_cast<char*>(arg));
+            }
+        }
+
+        // Every parser must agree on every command line
+        for (auto& line : lines) {
+            options expected;
+            bool parsed = parse_getopt(int(line.size()), line.data(), expected);
+            for (auto& p : parsers) {
+                options result;
+                if (!parsed || !p.parse(int(line.size()), line.data(), result)
+                    || !(result == expected)) {
+                    fprintf(stderr, "%s: %s disagrees\n", c.name, p.name);
+                    good = false;
+                }
+            }
+        }
+
+        for (auto& p : parsers) {
+            measurement m = measure(c, lines, iterations, counter, p.parse);
+            char instructions[32] = "n/a";
+            if (m.instructions_per_token >= 0) {
+                snprintf(
+                    instructions,
+                    sizeof(instructions),
+                    "%.1f",
+                    m.instructions_per_token);
+            }
+            printf(
+                "%-22s %-20s %14.1f %14s %14.2f\n",
+                c.name,
+                p.name,
+                m.tokens_per_second / 1e6,
+                instructions,
+                m.allocations_per_parse);
+            good = good && m.tokens_per_second > 0;
+        }
+    }
+    if (!counter.available()) {
+        printf("Hardware counters are unavailable; instructions not counted\n");
+    }
+    return !good;
+}
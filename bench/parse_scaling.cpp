@@ -0,0 +1,207 @@
+// Checks that the time taken by the legacy parser grows linearly with the size
+// of the command line, even for command lines built to be slow. A group tries
+// each of its parsers on every token, so a command line made entirely of
+// tokens which almost match a flag makes every parser do as much work as it
+// can before failing. Each corpus is generated at several sizes:
+//
+//     unknown flags     flags which no parser recognizes, taken as files
+//     near-miss flags   long flags which differ from a real flag by a little
+//     short cluster     a single "-vqar..." token made of many short flags
+//     bad cluster       the same, with an unknown flag at the very end
+//     repeated values   "-o x" given over and over
+//     repeated lists    "--include x" given over and over
+//
+// For each corpus, the time per parse is fit to size^k by least squares on a
+// log-log scale, and the benchmark fails if k exceeds the limit (1.4 unless
+// given), so that it can be run as a test.
+//
+// Usage: bench_parse_scaling [max exponent]
+#include <arglet/arglet.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string_view;
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> quiet;
+constexpr tag<2> all;
+constexpr tag<3> recursive;
+constexpr tag<4> output;
+constexpr tag<5> jobs;
+constexpr tag<6> color;
+constexpr tag<7> include;
+constexpr tag<8> files;
+} // namespace tags
+
+enum class color_mode { never, always, automatic };
+
+auto get_parser() {
+    using namespace arglet;
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {
+                flag {tags::verbose, 'v', "--verbose"},
+                flag {tags::quiet, 'q', "--quiet"},
+                flag {tags::all, 'a', "--all"},
+                flag {tags::recursive, 'r', "--recursive"}},
+            value_flag {tags::output, 'o', "--output", string_view()},
+            prefixed_value {tags::jobs, 'j', "--jobs=", 1},
+            option_set {
+                tags::color,
+                color_mode::never,
+                option {"--color=never", color_mode::never},
+                option {"--color=always", color_mode::always},
+                option {"--color=auto", color_mode::automatic}},
+            multi_value_flag {
+                tags::include, 'I', "--include", std::vector<string_view>()},
+            item {tags::files, std::vector<string_view>()}}};
+}
+
+// A command line, along with the storage for any tokens built for it
+struct command_line {
+    std::vector<std::string> storage;
+    std::vector<char const*> argv;
+};
+
+struct corpus {
+    char const* name;
+    // Builds a command line of the given size
+    command_line (*make)(size_t size);
+};
+
+// Repeats the tokens until there are size of them
+command_line repeat(size_t size, std::vector<char const*> tokens) {
+    command_line line;
+    line.argv.push_back("prog");
+    for (size_t i = 0; i < size; i++) {
+        line.argv.push_back(tokens[i % tokens.size()]);
+    }
+    return line;
+}
+
+// A single token of size short flags, followed by last
+command_line cluster(size_t size, char const* last) {
+    constexpr string_view flags = "vqar";
+    std::string token = "-";
+    for (size_t i = 0; i < size; i++) {
+        token += flags[i % flags.size()];
+    }
+    token += last;
+    command_line line;
+    line.storage.push_back(std::move(token));
+    line.argv = {"prog", line.storage[0].c_str()};
+    return line;
+}
+
+corpus const corpora[] {
+    {"unknown flags",
+     [](size_t size) {
+         return repeat(size, {"--no-such-flag", "-Z", "--", "-"});
+     }},
+    {"near-miss flags",
+     [](size_t size) {
+         return repeat(
+             size,
+             {"--verbos",
+              "--verbosee",
+              "--output=x",
+              "--jobs",
+              "--color=autp",
+              "--include="});
+     }},
+    {"short cluster", [](size_t size) { return cluster(size, ""); }},
+    {"bad cluster", [](size_t size) { return cluster(size, "Z"); }},
+    {"repeated values",
+     [](size_t size) { return repeat(size, {"-o", "x"}); }},
+    {"repeated lists",
+     [](size_t size) { return repeat(size, {"--include", "x"}); }},
+};
+
+// Returns the least time taken to parse the command line with a new parser,
+// in nanoseconds. Each round parses enough times to take a few milliseconds
+double time_parse(command_line& line) {
+    using clock = std::chrono::steady_clock;
+    constexpr auto round_time = std::chrono::milliseconds(4);
+    constexpr int num_rounds = 5;
+
+    int argc = int(line.argv.size());
+    double best = HUGE_VAL;
+    for (int round = 0; round < num_rounds; round++) {
+        size_t count = 0;
+        auto start = clock::now();
+        auto stop = start;
+        do {
+            auto parser = get_parser();
+            arglet::diagnostic diag;
+            intptr_t parsed =
+                arglet::parse(parser, argc, line.argv.data(), diag);
+            if (parsed != argc) {
+                fprintf(stderr, "Failed to parse the command line\n");
+                std::exit(1);
+            }
+            count++;
+            stop = clock::now();
+        } while (stop - start < round_time);
+        std::chrono::duration<double, std::nano> elapsed = stop - start;
+        best = std::min(best, elapsed.count() / double(count));
+    }
+    return best;
+}
+
+// Fits y = a + k x by least squares, and returns k
+double fit_slope(std::vector<double> const& x, std::vector<double> const& y) {
+    double n = double(x.size());
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        sx += x[i];
+        sy += y[i];
+        sxx += x[i] * x[i];
+        sxy += x[i] * y[i];
+    }
+    return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+int main(int argc, char const** argv) {
+    double max_exponent = argc > 1 ? std::atof(argv[1]) : 1.4;
+    if (max_exponent <= 0) {
+        fprintf(stderr, "Expected a positive exponent\n");
+        return 1;
+    }
+    constexpr size_t sizes[] {1024, 2048, 4096, 8192, 16384};
+
+    bool good = true;
+    printf("%-18s", "corpus");
+    for (size_t size : sizes) {
+        printf(" %9zu", size);
+    }
+    printf(" %9s\n", "exponent");
+    for (corpus const& c : corpora) {
+        std::vector<double> log_size;
+        std::vector<double> log_time;
+        printf("%-18s", c.name);
+        for (size_t size : sizes) {
+            command_line line = c.make(size);
+            double ns = time_parse(line);
+            // Nanoseconds per unit of size
+            printf(" %9.2f", ns / double(size));
+            log_size.push_back(std::log(double(size)));
+            log_time.push_back(std::log(ns));
+        }
+        double exponent = fit_slope(log_size, log_time);
+        bool linear = exponent <= max_exponent;
+        printf(" %9.2f%s\n", exponent, linear ? "" : "  super-linear");
+        good = good && linear;
+    }
+    printf("(nanoseconds per token, or per flag for the clusters)\n");
+    return !good;
+}
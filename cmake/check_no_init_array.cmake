@@ -0,0 +1,11 @@
+# Fails if an object file has a section for dynamic initializers. Section
+# names are stored as strings in the object file, so no binary tools are
+# needed. Run with: cmake -DOBJECT=<file> -P check_no_init_array.cmake
+if(NOT EXISTS "${OBJECT}")
+    message(FATAL_ERROR "No object file at '${OBJECT}'")
+endif()
+file(STRINGS "${OBJECT}" sections REGEX "\\.(init_array|ctors)")
+if(sections)
+    message(FATAL_ERROR
+        "${OBJECT} has dynamic initializers: ${sections}")
+endif()
@@ -0,0 +1,56 @@
+# Prints how much the size of each program changes between two builds of it.
+# PAIRS names a file with one line per program, holding its name and the
+# paths to the two builds, separated by '|'. Sizes are of the whole file, so
+# they include the symbol table. Run with:
+#
+#     cmake -DPAIRS=<file> [-DLABEL=<name of the second build>] \
+#         -P report_size_delta.cmake
+if(NOT EXISTS "${PAIRS}")
+    message(FATAL_ERROR "No list of programs at '${PAIRS}'")
+endif()
+if(NOT LABEL)
+    set(LABEL "variant")
+endif()
+
+# Formats numerator / denominator as a signed percentage with one decimal
+function(format_percent numerator denominator result)
+    math(EXPR tenths "(${numerator} * 1000) / ${denominator}")
+    if(tenths LESS 0)
+        set(sign "-")
+        math(EXPR tenths "-(${tenths})")
+    else()
+        set(sign "+")
+    endif()
+    math(EXPR whole "${tenths} / 10")
+    math(EXPR fraction "${tenths} % 10")
+    set(${result} "${sign}${whole}.${fraction}%" PARENT_SCOPE)
+endfunction()
+
+file(STRINGS "${PAIRS}" lines)
+set(total_before 0)
+set(total_after 0)
+set(report "")
+foreach(line ${lines})
+    string(REPLACE "|" ";" fields "${line}")
+    list(GET fields 0 name)
+    list(GET fields 1 before_path)
+    list(GET fields 2 after_path)
+    foreach(path "${before_path}" "${after_path}")
+        if(NOT EXISTS "${path}")
+            message(FATAL_ERROR "'${path}' hasn't been built")
+        endif()
+    endforeach()
+    file(SIZE "${before_path}" before)
+    file(SIZE "${after_path}" after)
+    math(EXPR delta "${after} - ${before}")
+    format_percent(${delta} ${before} percent)
+    string(APPEND report
+        "  ${name}: ${before} -> ${after} bytes (${percent})\n")
+    math(EXPR total_before "${total_before} + ${before}")
+    math(EXPR total_after "${total_after} + ${after}")
+endforeach()
+
+math(EXPR total_delta "${total_after} - ${total_before}")
+format_percent(${total_delta} ${total_before} total_percent)
+message("Size of each program, default -> ${LABEL}:\n${report}"
+    "  total: ${total_before} -> ${total_after} bytes (${total_percent})")
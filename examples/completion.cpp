@@ -0,0 +1,32 @@
+#include <arglet/completion.hpp>
+#include <arglet/flags.hpp>
+#include <fmt/core.h>
+
+// Try it out with bash:
+//
+//     complete -C 'completion --arglet-complete' completion
+namespace {
+using namespace arglet::flags;
+using std::string_view_literals::operator""sv;
+
+constexpr auto flags = tuplet::tuple {
+    flag_arg<1, 1> {'v', "--version"},
+    flag_arg<1, 1> {'h', "--help"},
+    flag_arg<0, 1> {{}, "--color"},
+    flag_arg<0, 1> {{}, "--config"},
+    flag_arg<1, 1> {'q', "--quiet"},
+};
+constexpr auto long_flags = make_long_flag_map(flags);
+constexpr auto short_flags = make_short_flag_map(flags);
+constexpr std::array commands {"build"sv, "check"sv, "clean"sv, "run"sv};
+} // namespace
+
+int main(int argc, char const** argv) {
+    // Completion requests are answered before the program does anything else
+    if (arglet::completion::handle_request(
+            argc, argv, long_flags, short_flags, commands)) {
+        return 0;
+    }
+
+    fmt::print("Hello from the completion example!\n");
+}
@@ -3,6 +3,7 @@
 #include <string_view>
 
 #include <arglet/token.hpp>
+#include <arglet/token_range.hpp>
 #include <arglet/util.hpp>
 
 namespace arglet {
@@ -13,7 +14,7 @@ class arg_view {
     char const** end_ {nullptr};
     token current_arg {};
 
-    arg_view(char const** Start, char const** End) noexcept
+    constexpr arg_view(char const** Start, char const** End) noexcept
       : start_(Start)
       , end_(End) {}
 
@@ -74,6 +75,31 @@ class arg_view {
         }
     }
 
+    // Return every argument that hasn't been popped yet, without popping them
+    constexpr token_range remaining() const noexcept {
+        return {start_, end_};
+    }
+
+    // Pop every remaining argument at once, and return them as a range
+    constexpr token_range pop_remaining() noexcept {
+        token_range rest {start_, end_};
+        start_ = end_;
+        current_arg = token();
+        return rest;
+    }
+
+    // Keep only the first count arguments, dropping the rest. Has no effect if
+    // count is at least size()
+    constexpr void truncate(size_t count) noexcept {
+        if (count >= size()) {
+            return;
+        }
+        end_ = start_ + count;
+        if (count == 0) {
+            current_arg = token();
+        }
+    }
+
     // Return the token at the front of the list of arguments. Returns an empty
     // token if the list is empty.
     constexpr token peek() const noexcept { return current_arg; }
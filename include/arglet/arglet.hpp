@@ -1,5 +1,7 @@
 #pragma once
 
 #include <arglet/arg_view.hpp>
+#include <arglet/remaining.hpp>
 #include <arglet/token.hpp>
+#include <arglet/token_range.hpp>
 #include <arglet/util.hpp>
@@ -0,0 +1,144 @@
+#pragma once
+#include <algorithm>
+#include <arglet/util/array_map.hpp>
+#include <arglet/util/text_writer.hpp>
+#include <span>
+#include <string_view>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace arglet::completion {
+using std::string_view;
+
+// Shells request completions by running `program --arglet-complete <word>`.
+// The flag is hidden: it never appears in help text, and it's only recognized
+// as the first argument. Bash can use it directly via
+//
+//     complete -C 'program --arglet-complete' program
+//
+// in which case the command name, the word, and the previous word are passed
+inline constexpr string_view request_flag = "--arglet-complete";
+
+// Size of the stack buffer that completions are written into. Completions
+// that don't fit are dropped
+inline constexpr size_t buffer_size = 4096;
+
+// Write every key in a sorted map of long flags that starts with the given
+// prefix, one per line. The matching keys are found with a binary search
+template <class Value, size_t N>
+constexpr void write_matches(
+    util::array_map<string_view, Value, N> const& long_flags,
+    string_view prefix,
+    util::text_writer& out) {
+    for (size_t i = long_flags.lower_bound(prefix);
+         i < N && long_flags[i].key.starts_with(prefix);
+         i++) {
+        out.put(long_flags[i].key);
+        out.put('\n');
+    }
+}
+
+// Write the short flags in a sorted map that match the given word. "-" matches
+// every short flag, and "-x" matches only the flag 'x'
+template <class Value, size_t N>
+constexpr void write_matches(
+    util::array_map<char, Value, N> const& short_flags,
+    string_view word,
+    util::text_writer& out) {
+    if (word.size() == 1) {
+        for (auto& entry : short_flags) {
+            out.put('-');
+            out.put(entry.key);
+            out.put('\n');
+        }
+    } else if (word.size() == 2 && word[1] != '-') {
+        size_t i = short_flags.lower_bound(word[1]);
+        if (i < N && short_flags[i].key == word[1]) {
+            out.put(word);
+            out.put('\n');
+        }
+    }
+}
+
+// Write every command in a sorted list of commands that starts with the given
+// prefix, one per line. The matching commands are found with a binary search
+constexpr void write_matches(
+    std::span<string_view const> commands,
+    string_view prefix,
+    util::text_writer& out) {
+    auto it = std::lower_bound(commands.begin(), commands.end(), prefix);
+    for (; it != commands.end() && it->starts_with(prefix); ++it) {
+        out.put(*it);
+        out.put('\n');
+    }
+}
+
+// Write the completions for a partially typed word. Words starting with '-'
+// are completed from the flags; other words are completed from the commands.
+// If there are no commands, an empty word is completed from the flags
+template <class LongMap, class ShortMap>
+constexpr void write_completions(
+    string_view word,
+    LongMap const& long_flags,
+    ShortMap const& short_flags,
+    std::span<string_view const> commands,
+    util::text_writer& out) {
+    if (!word.starts_with('-')) {
+        write_matches(commands, word, out);
+        if (!word.empty() || !commands.empty()) {
+            return;
+        }
+        word = "-";
+    }
+    write_matches(short_flags, word, out);
+    write_matches(long_flags, word, out);
+}
+
+// Returns the number of characters in the buffer of out that hold whole
+// completions. If the completions didn't fit, the buffer ends partway
+// through one, and everything after the last complete line is dropped
+constexpr size_t whole_lines_size(util::text_writer const& out) noexcept {
+    if (out.size <= out.capacity) {
+        return out.size;
+    }
+    string_view written(out.buffer, out.capacity);
+    size_t last_newline = written.rfind('\n');
+    return last_newline == string_view::npos ? 0 : last_newline + 1;
+}
+
+// Answer a completion request, if argv is one. This should be called at the
+// very start of main, before the program does any other work. The completions
+// are written to stdout with a single write from a buffer on the stack, so
+// nothing is allocated. Returns true if argv was a completion request, in
+// which case the program should exit.
+//
+// The flag maps are those created by make_long_flag_map and
+// make_short_flag_map, and commands must be sorted.
+template <class LongMap, class ShortMap>
+bool handle_request(
+    int argc,
+    char const** argv,
+    LongMap const& long_flags,
+    ShortMap const& short_flags,
+    std::span<string_view const> commands = {}) {
+    if (argc < 2 || argv[1] != request_flag) {
+        return false;
+    }
+    string_view word = argc > 3 ? argv[3] : argc > 2 ? argv[2] : "";
+
+    char buffer[buffer_size];
+    util::text_writer out {buffer, 0, buffer_size};
+    write_completions(word, long_flags, short_flags, commands, out);
+    size_t size = whole_lines_size(out);
+#ifdef _WIN32
+    [[maybe_unused]] auto written = _write(1, buffer, unsigned(size));
+#else
+    [[maybe_unused]] auto written = ::write(1, buffer, size);
+#endif
+    return true;
+}
+} // namespace arglet::completion
@@ -1,9 +1,12 @@
 #pragma once
 #include <arglet/util/array_map.hpp>
+#include <arglet/util/fixed_string.hpp>
+#include <arglet/util/text_writer.hpp>
 #include <array>
 #include <span>
 #include <string_view>
 #include <tuplet/tuple.hpp>
+#include <type_traits>
 
 namespace arglet::flags {
 using std::string_view;
@@ -18,6 +21,124 @@ struct flag_arg {
 template <size_t NS, size_t NL>
 flag_arg(std::array<char, NS>, std::array<string_view, NL>) -> flag_arg<NS, NL>;
 
+namespace detail {
+// Reaching this during constant evaluation is a compile error, since it isn't
+// constexpr. The reason appears in the compiler's error message
+inline void invalid_flags(char const* reason) { (void)reason; }
+
+constexpr bool is_space(char c) noexcept { return c == ' ' || c == '\t'; }
+constexpr bool is_alnum(char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+           || (c >= '0' && c <= '9');
+}
+
+// Calls func with every comma-separated item in a flag spec, with the
+// surrounding whitespace removed
+template <class Func>
+constexpr void for_each_spec_item(string_view spec, Func func) {
+    for (bool more = true; more;) {
+        size_t end = spec.find(',');
+        more = end != string_view::npos;
+        string_view item = spec.substr(0, end);
+        while (!item.empty() && is_space(item.front())) {
+            item.remove_prefix(1);
+        }
+        while (!item.empty() && is_space(item.back())) {
+            item.remove_suffix(1);
+        }
+        func(item);
+        spec.remove_prefix(more ? end + 1 : spec.size());
+    }
+}
+
+// Returns false if the item isn't a well-formed flag. In constant evaluation,
+// that's a compile error instead
+constexpr bool check_flag_name(string_view item) {
+    if (item.size() < 2 || item[0] != '-') {
+        invalid_flags("every flag in a spec must start with '-'");
+        return false;
+    } else if (item[1] != '-') {
+        if (item.size() != 2 || item[1] <= ' ' || item[1] > '~') {
+            invalid_flags("a short flag is '-' followed by one character");
+            return false;
+        }
+    } else if (item.size() == 2 || !is_alnum(item[2])) {
+        invalid_flags("a long flag name must start with a letter or digit");
+        return false;
+    } else {
+        for (char c : item.substr(3)) {
+            if (!is_alnum(c) && c != '-' && c != '_') {
+                invalid_flags("a long flag name may only contain letters, "
+                              "digits, '-', and '_'");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+struct flag_spec_size {
+    size_t num_short = 0;
+    size_t num_long = 0;
+};
+
+// Checks that every item in a flag spec is a well-formed short flag ("-v") or
+// long flag ("--version"), and that no flag is given twice. Returns the number
+// of each kind of flag
+constexpr flag_spec_size check_flag_spec(string_view spec) {
+    flag_spec_size size;
+    for_each_spec_item(spec, [&](string_view item) {
+        check_flag_name(item);
+        (item[1] == '-' ? size.num_long : size.num_short)++;
+        string_view before = spec.substr(0, size_t(item.data() - spec.data()));
+        for_each_spec_item(before, [&](string_view other) {
+            if (other == item) {
+                invalid_flags("a flag is given twice in the same spec");
+            }
+        });
+    });
+    return size;
+}
+
+template <util::fixed_string Spec>
+consteval auto parse_flag_spec() {
+    constexpr flag_spec_size size = check_flag_spec(Spec.view());
+    flag_arg<size.num_short, size.num_long> result {};
+    size_t num_short = 0;
+    size_t num_long = 0;
+    for_each_spec_item(Spec.view(), [&](string_view item) {
+        if (item[1] == '-') {
+            result.long_flags[num_long++] = item;
+        } else {
+            result.short_flags[num_short++] = item[1];
+        }
+    });
+    return result;
+}
+
+// Checks that no key appears twice in a sorted flag map. This is only done in
+// constant evaluation, where a duplicate is a compile error
+template <class Map>
+constexpr void check_unique_keys(Map const& map) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 1; i < map.size(); i++) {
+            if (map[i - 1].key == map[i].key) {
+                invalid_flags("a flag is used by more than one flag arg");
+            }
+        }
+    }
+}
+} // namespace detail
+
+// The flag arg described by a comma-separated list of flags, sized to fit:
+//
+//     constexpr auto version = flag_spec<"-v, --version, --ver">;
+//
+// is a flag_arg<1, 2>. The spec is parsed and checked entirely at compile
+// time, and the long flags refer to the spec's static storage.
+template <util::fixed_string Spec>
+inline constexpr auto flag_spec = detail::parse_flag_spec<Spec>();
+
 // Generic type holding a reference to a concrete flag arg
 struct any_flag_arg {
     struct vtable_t {
@@ -61,8 +182,12 @@ struct any_flag_arg {
       : pointer(&arg)
       , vtable(&VTables<FlagArg>::table) {}
 
-    constexpr auto get_short_flags() { vtable->get_short_flags(pointer); }
-    constexpr auto get_long_flags() { vtable->get_long_flags(pointer); }
+    constexpr auto get_short_flags() const {
+        return vtable->get_short_flags(pointer);
+    }
+    constexpr auto get_long_flags() const {
+        return vtable->get_long_flags(pointer);
+    }
 };
 
 // Create an array_map of long flags for every flag arg in a tuple containing
@@ -81,6 +206,7 @@ constexpr auto make_long_flag_map(tuplet::tuple<T...> const& flags)
     });
 
     map.sort();
+    detail::check_unique_keys(map);
 
     return map;
 }
@@ -100,8 +226,56 @@ constexpr auto make_short_flag_map(tuplet::tuple<T...> const& flags)
     });
 
     map.sort();
+    detail::check_unique_keys(map);
 
     return map;
 }
 
+// Write a line of help text for every flag arg in a tuple containing flag args.
+// Each line lists the short flags of the flag arg, followed by its long flags
+template <class... T>
+constexpr void
+write_help(tuplet::tuple<T...> const& flags, util::text_writer& out) {
+    flags.for_each([&out](auto& flag_arg) {
+        string_view separator = "  ";
+        for (char key : flag_arg.short_flags) {
+            out.put(separator);
+            out.put('-');
+            out.put(key);
+            separator = ", ";
+        }
+        for (string_view key : flag_arg.long_flags) {
+            out.put(separator);
+            out.put(key);
+            separator = ", ";
+        }
+        out.put('\n');
+    });
+}
+
+namespace detail {
+template <auto GetFlags>
+constexpr auto make_help_text() {
+    constexpr size_t size = [] {
+        util::text_writer out;
+        write_help(GetFlags(), out);
+        return out.size;
+    }();
+    std::array<char, size + 1> text {};
+    util::text_writer out {text.data()};
+    write_help(GetFlags(), out);
+    return text;
+}
+
+template <auto GetFlags>
+inline constexpr auto help_text_storage = make_help_text<GetFlags>();
+} // namespace detail
+
+// Help text for the tuple of flag args returned by GetFlags, generated at
+// compile time and stored in a static, null-terminated buffer
+template <auto GetFlags>
+inline constexpr string_view help_text {
+    detail::help_text_storage<GetFlags>.data(),
+    detail::help_text_storage<GetFlags>.size() - 1};
+
 } // namespace arglet::flags
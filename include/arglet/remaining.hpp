@@ -0,0 +1,29 @@
+#pragma once
+#include <arglet/arg_view.hpp>
+#include <arglet/token_range.hpp>
+
+namespace arglet {
+// Captures every argument left in an arg_view, for programs that pass the
+// arguments on or iterate over them. Parsing only records where the arguments
+// are, so it takes the same time no matter how many are left.
+//
+// If the next argument is "--", it's skipped, and every argument after it is
+// captured as-is, including ones that look like flags.
+struct remaining {
+    token_range value;
+
+    // Takes the rest of the arguments. Always succeeds
+    constexpr bool parse(arg_view& args) noexcept {
+        if (string_view(args.current()) == "--") {
+            args.pop();
+        }
+        value = args.pop_remaining();
+        return true;
+    }
+
+    constexpr token_range const& operator*() const noexcept { return value; }
+    constexpr token_range const* operator->() const noexcept {
+        return &value;
+    }
+};
+} // namespace arglet
@@ -0,0 +1,256 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <arglet/arg_view.hpp>
+#include <arglet/flags.hpp>
+#include <arglet/token.hpp>
+#include <arglet/util/array_map.hpp>
+
+// A schema is a set of options that's built at runtime, for options which
+// aren't known until the program runs (such as those registered by plugins):
+//
+//     arglet::flags::schema options;
+//     size_t verbose = options.add("-v, --verbose");
+//     size_t output = options.add("-o, --output", option_kind::value);
+//     options.finalize();
+//
+//     std::vector<slot> slots(options.size());
+//     options.parse(args, slots);
+//     if (slots[verbose]) { ... }
+//
+// Once finalized, the long flags are a sorted table searched the same way as a
+// flag map, and the short flags index a table directly. Tables are shared by
+// every option, so adding an option never allocates anything of its own.
+namespace arglet::flags {
+using std::string_view;
+
+// Whether an option stands alone, or is followed by a value
+enum class option_kind : unsigned char {
+    flag,
+    value,
+};
+
+// The result of parsing one option. Every option has the same kind of slot,
+// whatever it's used for, and the value is a view into the arguments
+struct slot {
+    // Number of times the option was given
+    uint32_t count = 0;
+    // The value given the last time the option was given, if it takes one
+    token value {};
+
+    // True if the option was given
+    constexpr explicit operator bool() const noexcept { return count > 0; }
+};
+
+class schema {
+    using index_t = uint32_t;
+    // Short flags index a table directly. Entries hold the index of the
+    // option plus one, or 0 if the flag is unused
+    constexpr static size_t short_table_size = 256;
+
+    std::vector<util::map_entry<string_view, index_t>> long_flags;
+    std::vector<option_kind> kinds;
+    std::array<index_t, short_table_size> short_flags {};
+    bool has_duplicate = false;
+    bool finalized = false;
+
+    void add_flag(string_view flag, index_t index) {
+        if (flag[1] == '-') {
+            long_flags.push_back({flag, index});
+        } else {
+            add_flag(flag[1], index);
+        }
+    }
+    void add_flag(char flag, index_t index) {
+        index_t& entry = short_flags[static_cast<unsigned char>(flag)];
+        has_duplicate = has_duplicate || entry != 0;
+        entry = index + 1;
+    }
+
+    // Parses "--name", "--name=value", or "--name value"
+    bool parse_long(arg_view& args, token arg, std::span<slot> slots)
+        const noexcept {
+        size_t eq = arg.find('=');
+        size_t index = find(arg.substr(0, eq));
+        if (index == npos) {
+            return false;
+        }
+        slot& s = slots[index];
+        if (kinds[index] == option_kind::flag) {
+            if (eq != string_view::npos) {
+                return false;
+            }
+        } else if (eq != string_view::npos) {
+            s.value = token(arg.data() + eq + 1, arg.size() - eq - 1);
+        } else if (args.size() < 2) {
+            return false;
+        } else {
+            args.pop();
+            s.value = args.current();
+        }
+        s.count++;
+        args.pop();
+        return true;
+    }
+
+    // Parses a group of short flags, such as "-abc". A short flag that takes
+    // a value uses the rest of the group ("-ofile"), or the next argument.
+    // The whole group is checked before any slot is updated, so a group that
+    // fails leaves the slots unchanged
+    bool parse_short(arg_view& args, token arg, std::span<slot> slots)
+        const noexcept {
+        // Position of the flag that takes a value, if there is one
+        size_t value_pos = arg.size();
+        for (size_t i = 1; i < arg.size(); i++) {
+            size_t index = find(arg[i]);
+            if (index == npos) {
+                return false;
+            }
+            if (kinds[index] == option_kind::value) {
+                value_pos = i;
+                break;
+            }
+        }
+        if (value_pos + 1 == arg.size() && args.size() < 2) {
+            return false;
+        }
+        for (size_t i = 1; i < value_pos; i++) {
+            slots[find(arg[i])].count++;
+        }
+        if (value_pos < arg.size()) {
+            slot& s = slots[find(arg[value_pos])];
+            if (value_pos + 1 < arg.size()) {
+                s.value = token(
+                    arg.data() + value_pos + 1, arg.size() - value_pos - 1);
+            } else {
+                args.pop();
+                s.value = args.current();
+            }
+            s.count++;
+        }
+        args.pop();
+        return true;
+    }
+
+   public:
+    constexpr static size_t npos = size_t(-1);
+
+    // Adds an option with the flags in a comma-separated spec, like the ones
+    // given to flag_spec. Returns the index of the option's slot, or npos if
+    // the spec is empty or malformed. Long flags refer to the spec, which must
+    // outlive the schema
+    size_t add(string_view spec, option_kind kind = option_kind::flag) {
+        bool good = true;
+        detail::for_each_spec_item(spec, [&](string_view item) {
+            good = good && detail::check_flag_name(item);
+        });
+        if (!good) {
+            return npos;
+        }
+        index_t index = index_t(kinds.size());
+        detail::for_each_spec_item(
+            spec, [&](string_view item) { add_flag(item, index); });
+        kinds.push_back(kind);
+        finalized = false;
+        return index;
+    }
+
+    // Adds an option with the flags of a flag arg (or of the flag arg
+    // referred to by an any_flag_arg), which must outlive the schema. Returns
+    // the index of the option's slot, or npos if there are no flags
+    template <class FlagArg>
+        requires std::same_as<FlagArg, any_flag_arg>
+                 || requires(FlagArg const& a) {
+                        a.short_flags;
+                        a.long_flags;
+                    }
+    size_t add(FlagArg const& flag_arg, option_kind kind = option_kind::flag) {
+        any_flag_arg arg(flag_arg);
+        if (!arg.vtable
+            || (arg.get_short_flags().empty()
+                && arg.get_long_flags().empty())) {
+            return npos;
+        }
+        index_t index = index_t(kinds.size());
+        for (char flag : arg.get_short_flags()) {
+            add_flag(flag, index);
+        }
+        for (string_view flag : arg.get_long_flags()) {
+            long_flags.push_back({flag, index});
+        }
+        kinds.push_back(kind);
+        finalized = false;
+        return index;
+    }
+
+    // Sorts the long flags, so that the schema can be used for parsing.
+    // Returns false if a flag is used by more than one option
+    bool finalize() {
+        std::sort(
+            long_flags.begin(), long_flags.end(), [](auto& a, auto& b) {
+                return a.key < b.key;
+            });
+        for (size_t i = 1; i < long_flags.size(); i++) {
+            has_duplicate =
+                has_duplicate || long_flags[i - 1].key == long_flags[i].key;
+        }
+        finalized = !has_duplicate;
+        return finalized;
+    }
+
+    // Number of options, which is the number of slots needed for parsing
+    size_t size() const noexcept { return kinds.size(); }
+
+    option_kind kind(size_t index) const noexcept { return kinds[index]; }
+
+    // Returns the index of the option with the given long flag, or npos
+    size_t find(string_view flag) const noexcept {
+        auto it = std::lower_bound(
+            long_flags.begin(),
+            long_flags.end(),
+            flag,
+            [](auto& entry, string_view key) { return entry.key < key; });
+        return it != long_flags.end() && it->key == flag ? it->value : npos;
+    }
+
+    // Returns the index of the option with the given short flag, or npos
+    size_t find(char flag) const noexcept {
+        return size_t(short_flags[static_cast<unsigned char>(flag)]) - 1;
+    }
+
+    // Parses flags from the front of args, recording each one in the slot
+    // for its option. slots must have size() elements. Parsing stops at the
+    // first argument that isn't a flag, or after "--". Returns false if the
+    // schema isn't finalized, or if a flag isn't recognized or is missing its
+    // value, in which case that flag is the current argument
+    bool parse(arg_view& args, std::span<slot> slots) const noexcept {
+        if (!finalized || slots.size() < kinds.size()) {
+            return false;
+        }
+        while (args) {
+            token arg = args.current();
+            if (arg.size() < 2 || arg[0] != '-') {
+                return true;
+            }
+            if (arg[1] == '-') {
+                if (arg.size() == 2) {
+                    args.pop();
+                    return true;
+                }
+                if (!parse_long(args, arg, slots)) {
+                    return false;
+                }
+            } else if (!parse_short(args, arg, slots)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+} // namespace arglet::flags
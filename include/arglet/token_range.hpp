@@ -0,0 +1,98 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <iterator>
+
+#include <arglet/token.hpp>
+
+namespace arglet {
+// A view of a range of arguments. Tokens are made from the arguments as the
+// range is read, so a token_range is two pointers regardless of its size, and
+// nothing is copied or converted up front.
+class token_range {
+    char const* const* begin_ {nullptr};
+    char const* const* end_ {nullptr};
+
+   public:
+    class iterator {
+        char const* const* pos {nullptr};
+
+       public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = token;
+        using difference_type = std::ptrdiff_t;
+        using reference = token;
+
+        iterator() = default;
+        constexpr explicit iterator(char const* const* pos) noexcept
+          : pos(pos) {}
+
+        constexpr token operator*() const noexcept { return token(*pos); }
+        constexpr token operator[](difference_type i) const noexcept {
+            return token(pos[i]);
+        }
+
+        constexpr iterator& operator++() noexcept {
+            ++pos;
+            return *this;
+        }
+        constexpr iterator operator++(int) noexcept {
+            return iterator(pos++);
+        }
+        constexpr iterator& operator--() noexcept {
+            --pos;
+            return *this;
+        }
+        constexpr iterator operator--(int) noexcept {
+            return iterator(pos--);
+        }
+        constexpr iterator& operator+=(difference_type n) noexcept {
+            pos += n;
+            return *this;
+        }
+        constexpr iterator& operator-=(difference_type n) noexcept {
+            pos -= n;
+            return *this;
+        }
+        constexpr friend iterator
+        operator+(iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+        constexpr friend iterator
+        operator+(difference_type n, iterator it) noexcept {
+            return it += n;
+        }
+        constexpr friend iterator
+        operator-(iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+        constexpr friend difference_type
+        operator-(iterator a, iterator b) noexcept {
+            return a.pos - b.pos;
+        }
+
+        constexpr bool operator==(iterator const&) const = default;
+        constexpr auto operator<=>(iterator const&) const = default;
+    };
+
+    token_range() = default;
+    constexpr token_range(
+        char const* const* begin, char const* const* end) noexcept
+      : begin_(begin)
+      , end_(end) {}
+
+    constexpr iterator begin() const noexcept { return iterator(begin_); }
+    constexpr iterator end() const noexcept { return iterator(end_); }
+
+    // Get the number of tokens in the range
+    constexpr size_t size() const noexcept { return end_ - begin_; }
+    // Checks if the range is empty (has 0 elements)
+    constexpr bool empty() const noexcept { return begin_ == end_; }
+
+    constexpr token operator[](size_t i) const noexcept {
+        return token(begin_[i]);
+    }
+    constexpr token front() const noexcept { return token(*begin_); }
+    constexpr token back() const noexcept { return token(end_[-1]); }
+};
+} // namespace arglet
@@ -0,0 +1,356 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include <arglet/arg_view.hpp>
+#include <arglet/token.hpp>
+#include <arglet/token_range.hpp>
+
+#if (defined(__x86_64__) || defined(__i386__))                                 \
+    && (defined(__GNUC__) || defined(__clang__))
+#define ARGLET_UTF8_SSSE3 1
+#include <immintrin.h>
+#endif
+
+// UTF-8 validation of arguments, so that malformed input can be reported (or
+// rejected) before any parser sees it:
+//
+//     arglet::arg_view args(argc, argv);
+//     auto diag = arglet::utf8::validate(args, arglet::utf8::policy::reject);
+//     if (diag) {
+//         // args now ends before diag.token
+//     }
+//
+// Long arguments are checked 16 bytes at a time with the lookup-table
+// algorithm from Keiser and Lemire, "Validating UTF-8 in less than one
+// instruction per byte". The SIMD path is chosen at runtime on x86, and the
+// scalar path is used everywhere else, including in constant evaluation.
+namespace arglet::utf8 {
+using std::string_view;
+
+namespace detail {
+// Returns the offset of the first sequence in text which isn't well-formed
+// UTF-8, starting the search at offset i, or text.size() if there is none.
+// Follows table 3-7 of the Unicode standard, so overlong encodings,
+// surrogates, and code points above U+10FFFF are all invalid
+constexpr size_t find_invalid_scalar(string_view text, size_t i = 0) noexcept {
+    size_t size = text.size();
+    while (i < size) {
+        unsigned char c = text[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        size_t length;
+        // Range of the second byte, which is narrower for some lead bytes
+        unsigned char lo = 0x80, hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+            lo = c == 0xE0 ? 0xA0 : lo;
+            hi = c == 0xED ? 0x9F : hi;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+            lo = c == 0xF0 ? 0x90 : lo;
+            hi = c == 0xF4 ? 0x8F : hi;
+        } else {
+            return i;
+        }
+        if (size - i < length) {
+            return i;
+        }
+        unsigned char second = text[i + 1];
+        if (second < lo || second > hi) {
+            return i;
+        }
+        for (size_t k = 2; k < length; k++) {
+            if ((static_cast<unsigned char>(text[i + k]) & 0xC0) != 0x80) {
+                return i;
+            }
+        }
+        i += length;
+    }
+    return size;
+}
+
+// Returns the length of the prefix of text which is ASCII, rounded down to a
+// multiple of 8. Reads 8 bytes at a time
+inline size_t ascii_prefix(string_view text) noexcept {
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, text.data() + i, sizeof(word));
+        if (word & 0x8080808080808080u) {
+            break;
+        }
+    }
+    return i;
+}
+
+#ifdef ARGLET_UTF8_SSSE3
+#define ARGLET_TARGET_SSSE3 __attribute__((target("ssse3")))
+
+// Bits of the error classes. Each lookup gives the classes consistent with
+// one of the three nibbles, and a pair of bytes is invalid if some class is
+// consistent with all three
+enum : unsigned char {
+    too_short = 1 << 0,
+    too_long = 1 << 1,
+    overlong_3 = 1 << 2,
+    too_large = 1 << 3,
+    surrogate = 1 << 4,
+    overlong_2 = 1 << 5,
+    too_large_1000 = 1 << 6,
+    overlong_4 = 1 << 6,
+    two_conts = 1 << 7,
+    carry = too_short | too_long | two_conts,
+};
+
+ARGLET_TARGET_SSSE3 inline __m128i
+lookup(__m128i index, unsigned char const (&table)[16]) noexcept {
+    __m128i t = _mm_loadu_si128(reinterpret_cast<__m128i const*>(table));
+    return _mm_shuffle_epi8(t, index);
+}
+
+ARGLET_TARGET_SSSE3 inline __m128i high_nibbles(__m128i v) noexcept {
+    return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+
+// Classifies each pair of adjacent bytes by the high nibble of the first
+// byte, the low nibble of the first byte, and the high nibble of the second
+ARGLET_TARGET_SSSE3 inline __m128i
+special_cases(__m128i input, __m128i prev1) noexcept {
+    constexpr static unsigned char byte_1_high[16] {
+        // 0_______: ASCII
+        too_long,
+        too_long,
+        too_long,
+        too_long,
+        too_long,
+        too_long,
+        too_long,
+        too_long,
+        // 10______: continuation
+        two_conts,
+        two_conts,
+        two_conts,
+        two_conts,
+        // 1100____: two byte lead
+        too_short | overlong_2,
+        // 1101____: two byte lead
+        too_short,
+        // 1110____: three byte lead
+        too_short | overlong_3 | surrogate,
+        // 1111____: four byte lead
+        too_short | too_large | too_large_1000 | overlong_4,
+    };
+    constexpr static unsigned char byte_1_low[16] {
+        carry | overlong_3 | overlong_2 | overlong_4,
+        carry | overlong_2,
+        carry,
+        carry,
+        carry | too_large,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000 | surrogate,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+    };
+    constexpr static unsigned char byte_2_high[16] {
+        // 0_______: ASCII
+        too_short,
+        too_short,
+        too_short,
+        too_short,
+        too_short,
+        too_short,
+        too_short,
+        too_short,
+        // 1000____
+        too_long | overlong_2 | two_conts | overlong_3 | too_large_1000
+            | overlong_4,
+        // 1001____
+        too_long | overlong_2 | two_conts | overlong_3 | too_large,
+        // 101_____
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        // 11______: lead byte
+        too_short,
+        too_short,
+        too_short,
+        too_short,
+    };
+    __m128i low = _mm_and_si128(prev1, _mm_set1_epi8(0x0F));
+    return _mm_and_si128(
+        _mm_and_si128(
+            lookup(high_nibbles(prev1), byte_1_high),
+            lookup(low, byte_1_low)),
+        lookup(high_nibbles(input), byte_2_high));
+}
+
+// Bytes which are the third or fourth byte of a sequence have 0x80 set
+ARGLET_TARGET_SSSE3 inline __m128i
+must_be_continuation(__m128i prev2, __m128i prev3) noexcept {
+    __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xE0 - 0x80)));
+    __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xF0 - 0x80)));
+    __m128i high_bit = _mm_set1_epi8(char(0x80));
+    return _mm_and_si128(_mm_or_si128(third, fourth), high_bit);
+}
+
+// Nonzero if the block ends partway through a sequence
+ARGLET_TARGET_SSSE3 inline __m128i is_incomplete(__m128i input) noexcept {
+    // The last three bytes may not start sequences longer than what's left
+    __m128i max = _mm_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        char(0xF0 - 1),
+        char(0xE0 - 1),
+        char(0xC0 - 1));
+    return _mm_subs_epu8(input, max);
+}
+
+struct block_state {
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+};
+
+ARGLET_TARGET_SSSE3 inline void
+check_block(block_state& s, __m128i input) noexcept {
+    if (_mm_movemask_epi8(input) == 0) {
+        // An ASCII block is valid unless the previous block was incomplete
+        s.error = _mm_or_si128(s.error, s.prev_incomplete);
+    } else {
+        __m128i prev1 = _mm_alignr_epi8(input, s.prev_input, 15);
+        __m128i prev2 = _mm_alignr_epi8(input, s.prev_input, 14);
+        __m128i prev3 = _mm_alignr_epi8(input, s.prev_input, 13);
+        __m128i cases = special_cases(input, prev1);
+        __m128i lengths =
+            _mm_xor_si128(must_be_continuation(prev2, prev3), cases);
+        s.error = _mm_or_si128(s.error, lengths);
+        s.prev_incomplete = is_incomplete(input);
+    }
+    s.prev_input = input;
+}
+
+// Returns true if text contains a sequence which isn't well-formed UTF-8. The
+// last partial block is copied into a zeroed buffer, so nothing past the end
+// of text is read
+ARGLET_TARGET_SSSE3 inline bool has_invalid_ssse3(string_view text) noexcept {
+    block_state s;
+    char const* data = text.data();
+    size_t size = text.size();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        check_block(
+            s, _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i)));
+    }
+    if (i < size) {
+        alignas(16) char tail[16] {};
+        std::memcpy(tail, data + i, size - i);
+        check_block(s, _mm_load_si128(reinterpret_cast<__m128i const*>(tail)));
+    }
+    __m128i error = _mm_or_si128(s.error, s.prev_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128()))
+           != 0xFFFF;
+}
+
+inline bool has_ssse3() noexcept {
+#ifdef __SSSE3__
+    return true;
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+#undef ARGLET_TARGET_SSSE3
+#endif
+} // namespace detail
+
+// Returns the offset of the first byte in text which doesn't begin a
+// well-formed UTF-8 sequence, or text.size() if all of text is valid
+constexpr size_t find_invalid(string_view text) noexcept {
+    if (std::is_constant_evaluated()) {
+        return detail::find_invalid_scalar(text);
+    }
+#ifdef ARGLET_UTF8_SSSE3
+    // Short arguments are cheaper to check one byte at a time. If a long
+    // argument is invalid, the scalar path finds where
+    if (text.size() >= 16 && detail::has_ssse3()) {
+        if (!detail::has_invalid_ssse3(text)) {
+            return text.size();
+        }
+        return detail::find_invalid_scalar(text);
+    }
+#endif
+    return detail::find_invalid_scalar(text, detail::ascii_prefix(text));
+}
+
+// Checks that all of text is well-formed UTF-8
+constexpr bool is_valid(string_view text) noexcept {
+    return find_invalid(text) == text.size();
+}
+
+// What to do with the arguments when one of them isn't valid UTF-8
+enum class policy {
+    // Leave the arguments as they are
+    report,
+    // Drop the first invalid argument, and every argument after it, so that
+    // parsing stops where the invalid argument was
+    reject,
+};
+
+// Describes the first argument which isn't valid UTF-8
+struct diagnostic {
+    // Index of the invalid argument, relative to the first argument checked,
+    // or -1 if every argument was valid
+    intptr_t arg_index = -1;
+    // Offset within the argument of the first invalid byte
+    size_t char_offset = 0;
+    // The invalid argument
+    arglet::token token {};
+    // Number of arguments which aren't valid UTF-8
+    size_t num_invalid = 0;
+
+    // True if some argument isn't valid UTF-8
+    constexpr explicit operator bool() const noexcept { return arg_index >= 0; }
+};
+
+// Checks every token in the range
+constexpr diagnostic validate(token_range tokens) noexcept {
+    diagnostic diag;
+    intptr_t index = 0;
+    for (auto tok : tokens) {
+        size_t offset = find_invalid(tok);
+        if (offset != tok.size()) {
+            if (diag.num_invalid++ == 0) {
+                diag.arg_index = index;
+                diag.char_offset = offset;
+                diag.token = tok;
+            }
+        }
+        index++;
+    }
+    return diag;
+}
+
+// Checks every argument remaining in args, including the current one. With
+// policy::reject, args is truncated before the first invalid argument
+constexpr diagnostic
+validate(arg_view& args, policy action = policy::report) noexcept {
+    diagnostic diag = validate(args.remaining());
+    if (diag && action == policy::reject) {
+        args.truncate(size_t(diag.arg_index));
+    }
+    return diag;
+}
+} // namespace arglet::utf8
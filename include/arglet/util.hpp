@@ -3,7 +3,7 @@
 
 namespace arglet::util {
 template <class T>
-T exchange(T& value, T&& moved) noexcept(
+constexpr T exchange(T& value, T&& moved) noexcept(
     std::is_nothrow_move_constructible_v<T>&&
         std::is_nothrow_move_assignable_v<T>) {
     T tmp = static_cast<T&&>(value);
@@ -56,10 +56,25 @@ class array_map {
         return i;
     }
 
+    // Find the index of the first item whose key is not less than the arg,
+    // using binary search. Returns N if every key is less than the arg
+    constexpr size_t lower_bound(Key const& arg) const {
+        size_t min = 0, max = N;
+        while (min < max) {
+            size_t i = min + (max - min) / 2;
+            if (entries[i].key < arg) {
+                min = i + 1;
+            } else {
+                max = i;
+            }
+        }
+        return min;
+    }
+
     constexpr entry_type* begin() noexcept { return entries; }
-    constexpr entry_type* end() noexcept { return entries; }
+    constexpr entry_type* end() noexcept { return entries + N; }
     constexpr entry_type const* begin() const noexcept { return entries; }
-    constexpr entry_type const* end() const noexcept { return entries; }
+    constexpr entry_type const* end() const noexcept { return entries + N; }
 
     // Performs a linear search to find the best element
     template <class Func>
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+namespace arglet::util {
+// A string literal which can be used as a template argument. The string is
+// stored with its null terminator
+template <size_t N>
+struct fixed_string {
+    char data[N] {};
+
+    constexpr fixed_string(char const (&str)[N]) noexcept {
+        for (size_t i = 0; i < N; i++) {
+            data[i] = str[i];
+        }
+    }
+
+    constexpr static size_t size() noexcept { return N - 1; }
+    constexpr std::string_view view() const noexcept { return {data, N - 1}; }
+};
+} // namespace arglet::util
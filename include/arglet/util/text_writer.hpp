@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace arglet::util {
+// Writes text into a buffer. If no buffer is given, the writer only counts
+// the number of characters that would have been written, so that the text
+// can be measured and then written into a buffer of the right size during
+// constant evaluation. Characters past the capacity of the buffer are counted
+// but not written
+struct text_writer {
+    char* buffer = nullptr;
+    size_t size = 0;
+    size_t capacity = size_t(-1);
+
+    constexpr void put(char c) noexcept {
+        if (buffer && size < capacity) {
+            buffer[size] = c;
+        }
+        size++;
+    }
+    constexpr void put(std::string_view str) noexcept {
+        if (!std::is_constant_evaluated() && buffer && size <= capacity
+            && str.size() <= capacity - size) {
+            std::memcpy(buffer + size, str.data(), str.size());
+            size += str.size();
+            return;
+        }
+        for (char c : str) {
+            put(c);
+        }
+    }
+    // Writes a non-negative integer in base 10
+    constexpr void put_integer(size_t value) noexcept {
+        char digits[20] {};
+        size_t count = 0;
+        do {
+            digits[count++] = char('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (count > 0) {
+            put(digits[--count]);
+        }
+    }
+};
+} // namespace arglet::util
@@ -2,6 +2,7 @@
 #include <cmath>
 #include <filesystem>
 #include <iostream>
+#include <unistd.h>
 
 namespace tags {
 using namespace arglet;
@@ -17,12 +18,16 @@ constexpr tag<8> list_recurse;
 constexpr tag<9> block_size;
 constexpr tag<10> files;
 constexpr tag<11> column_width;
+constexpr tag<12> show_help;
 } // namespace tags
 enum class show_mode { regular, almost_all, all };
 enum class size_display_mode { bytes, kibi, kilo };
 enum class color_mode { always, never, automatic };
 enum class sort_mode { none, file_size, time, extension };
-auto parse_block_size(std::string_view arg) -> unsigned long long {
+// Returns an empty optional if the block size is malformed, which the parser
+// reports as an invalid value
+auto parse_block_size(std::string_view arg)
+    -> std::optional<unsigned long long> {
     unsigned long long value = 0;
     auto [scan, errc] = std::from_chars(&*arg.begin(), &*arg.end(), value);
     if (scan == &*arg.end()) {
@@ -38,8 +43,6 @@ auto parse_block_size(std::string_view arg) -> unsigned long long {
             case 'Z': return value * std::pow(1024ull, 7);
             case 'Y': return value * std::pow(1024ull, 8);
         }
-        throw std::logic_error(
-            std::string("Unrecognized suffix in --block_size=") + arg.data());
     } else if (scan + 2 == &*arg.end() && scan[1] == 'B') {
         switch (*scan) {
             case 'K': return value * std::pow(1000ull, 1);
@@ -51,15 +54,10 @@ auto parse_block_size(std::string_view arg) -> unsigned long long {
             case 'Z': return value * std::pow(1000ull, 7);
             case 'Y': return value * std::pow(1000ull, 8);
         }
-        throw std::logic_error(
-            std::string("Unrecognized suffix in --block_size=") + arg.data());
     }
-    throw std::logic_error(
-        std::string(
-            "Block size specification must be a number in --block_size=")
-        + arg.data());
-};
-auto get_parser() {
+    return std::nullopt;
+}
+constexpr auto get_parser() {
     using namespace tags;
     using namespace arglet;
     return sequence {
@@ -87,6 +85,7 @@ auto get_parser() {
                 flag {reverse_order, 'r'},
                 flag {list_recurse, 'R'},
                 flag {show_block_size, 's'},
+                flag {show_help, "--help"},
                 option_set {
                     sort_method,
                     sort_mode::none,
@@ -151,6 +150,15 @@ void print_values(T& parser, std::index_sequence<I...>) {
 
 int main(int argc, char const** argv) {
     auto parser = get_parser();
-    parser.parse(argc, argv);
+    arglet::diagnostic diag;
+    if (arglet::parse(parser, argc, argv, diag) != argc) {
+        diag.print();
+        return 1;
+    }
+    if (parser[tags::show_help]) {
+        // The help text is generated at compile time
+        constexpr auto help = arglet::help_text<get_parser, "ls">;
+        return write(STDOUT_FILENO, help.data(), help.size()) < 0;
+    }
     print_values(parser, std::make_index_sequence<12>());
 }
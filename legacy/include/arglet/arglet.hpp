@@ -1,13 +1,30 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <charconv>
+#include <chrono>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include <arglet/utf8.hpp>
+#include <arglet/util/fixed_string.hpp>
+#include <arglet/util/text_writer.hpp>
+
 // arglet::index implementation
 // arglet::tag implementation
 // arglet::string_literal implementation
@@ -46,23 +63,16 @@ struct tuple_elem {
     }
 };
 
-template <size_t I, class... T>
-struct partial_tuple {}; // Represents an empty tuple
-
-template <size_t I, class T>
-struct partial_tuple<I, T> : tuple_elem<I, T> {
-    using tuple_elem<I, T>::decl_elem;
-    using tuple_elem<I, T>::operator[];
-};
+// Flat storage for a list of types. Every element is a direct base, and
+// elements are looked up by index through a single overload set, so the depth
+// of the inheritance tree doesn't grow with the number of elements
+template <class IndexSequence, class... T>
+struct tuple_base;
 
-template <size_t I, class T, class... Rest>
-struct partial_tuple<I, T, Rest...>
-  : tuple_elem<I, T>
-  , partial_tuple<I + 1, Rest...> {
-    using tuple_elem<I, T>::decl_elem;
-    using tuple_elem<I, T>::operator[];
-    using partial_tuple<I + 1, Rest...>::decl_elem;
-    using partial_tuple<I + 1, Rest...>::operator[];
+template <size_t... I, class... T>
+struct tuple_base<std::index_sequence<I...>, T...> : tuple_elem<I, T>... {
+    using tuple_elem<I, T>::decl_elem...;
+    using tuple_elem<I, T>::operator[]...;
 };
 } // namespace arglet::detail
 
@@ -78,15 +88,15 @@ struct ignore_function_arg {
 };
 
 template <class... T>
-auto save_state(T... values) {
+constexpr auto save_state(T... values) {
     return [... saved_state = values](T&... values_to_restore) {
         (void(values_to_restore = saved_state), ...);
     };
 }
 
 template <class... T>
-struct type_array : detail::partial_tuple<0, T...> {
-    using detail::partial_tuple<0, T...>::operator[];
+struct type_array : detail::tuple_base<std::index_sequence_for<T...>, T...> {
+    using detail::tuple_base<std::index_sequence_for<T...>, T...>::operator[];
 };
 template <class... T>
 type_array(T...) -> type_array<T...>;
@@ -120,8 +130,600 @@ template <class T>
 using wrap_optional = typename is_optional<T>::optional_type;
 } // namespace arglet::traits
 
+// arglet::detail::text_writer implementation
+// arglet::detail::fixed_string implementation
+namespace arglet::detail {
+// Both are shared with the flag maps in arglet/flags.hpp
+using util::fixed_string;
+using util::text_writer;
+
+// Parsers describe themselves through write_usage (a fragment of the usage
+// line) and write_help (zero or more lines of the option listing). Parsers
+// that don't provide these are left out of the help text
+template <class Parser>
+constexpr void write_usage(Parser const& parser, text_writer& out) {
+    if constexpr (requires { parser.write_usage(out); }) {
+        parser.write_usage(out);
+    }
+}
+template <class Parser>
+constexpr void write_help(Parser const& parser, text_writer& out) {
+    if constexpr (requires { parser.write_help(out); }) {
+        parser.write_help(out);
+    }
+}
+} // namespace arglet::detail
+
+// arglet::error_kind implementation
+// arglet::diagnostic implementation
+namespace arglet {
+enum class error_kind : unsigned char {
+    none,
+    // No parser accepted the argument
+    unrecognized_argument,
+    // A character in a group of short flags didn't match any flag
+    unrecognized_flag,
+    // A flag that takes a value was given without one
+    missing_value,
+    // The value given to a flag couldn't be parsed
+    invalid_value,
+    // The argument isn't well-formed UTF-8
+    invalid_utf8,
+};
+
+constexpr std::string_view describe(error_kind kind) noexcept {
+    switch (kind) {
+        case error_kind::none: return "no error";
+        case error_kind::unrecognized_argument: return "unrecognized argument";
+        case error_kind::unrecognized_flag: return "unrecognized flag";
+        case error_kind::missing_value: return "missing value for";
+        case error_kind::invalid_value: return "invalid value";
+        case error_kind::invalid_utf8: return "invalid UTF-8 in";
+    }
+    return "unknown error";
+}
+
+// Describes why parsing stopped. A diagnostic owns no storage: the token is a
+// view into argv, and the parser name is a string literal, so recording an
+// error never allocates and never throws. The message is only formatted when
+// it's written.
+struct diagnostic {
+    error_kind kind = error_kind::none;
+    // Index in argv of the rejected token
+    intptr_t arg_index = 0;
+    // Offset within the token at which the error was found
+    size_t char_offset = 0;
+    // The rejected token
+    std::string_view token {};
+    // Name of the parser which rejected the token
+    std::string_view parser {};
+    // Start of argv. This is set while parsing, and is used to compute the
+    // index of a rejected token. If it isn't set, as when a diagnostic is
+    // passed straight to a parser, the first token recorded is used instead,
+    // and indices are relative to it
+    char const** argv = nullptr;
+
+    constexpr explicit operator bool() const noexcept {
+        return kind != error_kind::none;
+    }
+
+    // Records an error at the given position in argv. The error furthest into
+    // argv is kept, since the parser that got the furthest is the most
+    // informative. Among errors at the same position, an error from a parser
+    // which recognized the token (a missing or invalid value) is preferred;
+    // otherwise the first one recorded is kept, because leaf parsers record
+    // errors before the groups containing them do.
+    constexpr void record(
+        error_kind new_kind,
+        char const** arg,
+        size_t offset,
+        std::string_view rejected_by) noexcept {
+        if (!argv) {
+            argv = arg;
+        }
+        intptr_t index = arg - argv;
+        if (kind != error_kind::none && index <= arg_index
+            && !(index == arg_index && recognized(new_kind)
+                 && !recognized(kind))) {
+            return;
+        }
+        kind = new_kind;
+        arg_index = index;
+        char_offset = offset;
+        token = *arg;
+        parser = rejected_by;
+    }
+
+    // True for errors from a parser which recognized the token
+    constexpr static bool recognized(error_kind kind) noexcept {
+        return kind == error_kind::missing_value
+               || kind == error_kind::invalid_value;
+    }
+
+    // Writes a message of the form
+    //
+    //     argument 2, offset 0: invalid value 'abc' (rejected by value_flag)
+    constexpr void write(detail::text_writer& out) const noexcept {
+        out.put("argument ");
+        out.put_integer(size_t(arg_index));
+        out.put(", offset ");
+        out.put_integer(char_offset);
+        out.put(": ");
+        out.put(describe(kind));
+        out.put(" '");
+        out.put(token);
+        out.put("' (rejected by ");
+        out.put(parser);
+        out.put(')');
+    }
+
+    // Formats the message into the buffer, truncating it if it doesn't fit.
+    // Returns the length of the full message. The buffer isn't null-terminated
+    constexpr size_t format(char* buffer, size_t size) const noexcept {
+        detail::text_writer out {buffer, 0, size};
+        write(out);
+        return out.size;
+    }
+
+    // Prints the message, followed by a newline
+    void print(FILE* file = stderr) const noexcept {
+        char buffer[256];
+        size_t size = format(buffer, sizeof(buffer));
+        fwrite(buffer, 1, size < sizeof(buffer) ? size : sizeof(buffer), file);
+        fputc('\n', file);
+    }
+};
+
+} // namespace arglet
+
+// arglet::parser_counters implementation
+// arglet::no_instrumentation implementation
+namespace arglet {
+// Counters for a single node in the parser tree. Cycles are inclusive: a
+// node's cycles include those spent in its children
+struct parser_counters {
+    // Number of times the parser was offered a token
+    uint64_t offered = 0;
+    // Number of tokens the parser consumed
+    uint64_t consumed = 0;
+    // Time spent in the parser, in cycles of the timestamp counter (or
+    // nanoseconds on targets without one)
+    uint64_t cycles = 0;
+};
+
+// One row in the flat table exported by a parse_profile
+struct profile_row {
+    // Name of the parser, eg "value_flag"
+    std::string_view parser;
+    // Depth of the node in the parser tree. The root has depth 0
+    size_t depth = 0;
+    parser_counters counters;
+};
+
+// The default instrumentation policy. Parsing with no_instrumentation is
+// exactly the same as parsing without a policy: probes are empty, and every
+// use of them is discarded with if constexpr
+struct no_instrumentation {
+    constexpr static bool enabled = false;
+
+    constexpr no_instrumentation probe() const noexcept { return {}; }
+    template <size_t Offset>
+    constexpr no_instrumentation child() const noexcept {
+        return {};
+    }
+};
+
+namespace detail {
+// Points at the counters of one node. Children of a node are found at fixed
+// offsets from it, since the nodes are numbered in depth-first order
+struct counting_probe {
+    constexpr static bool enabled = true;
+    parser_counters* node = nullptr;
+
+    template <size_t Offset>
+    constexpr counting_probe child() const noexcept {
+        return {node + Offset};
+    }
+};
+
+inline uint64_t read_cycles() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return uint64_t(now.count());
+#endif
+}
+
+// Describes the shape of the parser tree. Composite parsers specialize this
+// with the number of nodes below them and a way to name those nodes
+template <class Parser>
+struct node_info;
+
+// Index of the I-th child of a composite parser, relative to the composite
+template <size_t I, class... Arg>
+constexpr size_t child_offset = [] {
+    size_t counts[] {node_info<Arg>::count...};
+    size_t offset = 1;
+    for (size_t i = 0; i < I; i++) {
+        offset += counts[i];
+    }
+    return offset;
+}();
+
+// Invokes parser.parse(begin, end, diag) if the parser reports errors, and
+// parser.parse(begin, end) otherwise
+template <class Parser>
+constexpr char const** parse_with(
+    Parser& parser, char const** begin, char const** end, diagnostic& diag) {
+    if constexpr (requires { parser.parse(begin, end, diag); }) {
+        return parser.parse(begin, end, diag);
+    } else {
+        return parser.parse(begin, end);
+    }
+}
+
+// Parses with an instrumentation probe. Composite parsers are given the probe
+// so that they can pass it on to their children. If the probe is enabled, the
+// parser's counters are updated; otherwise this is the same as parsing without
+// a probe
+template <class Parser, class Probe>
+constexpr char const** parse_with(
+    Parser& parser,
+    char const** begin,
+    char const** end,
+    diagnostic& diag,
+    Probe probe) {
+    if constexpr (!Probe::enabled) {
+        return parse_with(parser, begin, end, diag);
+    } else {
+        bool timed = !std::is_constant_evaluated();
+        uint64_t start = timed ? read_cycles() : 0;
+        char const** stop;
+        if constexpr (requires { parser.parse(begin, end, diag, probe); }) {
+            stop = parser.parse(begin, end, diag, probe);
+        } else {
+            stop = parse_with(parser, begin, end, diag);
+        }
+        probe.node->offered += begin != end;
+        probe.node->consumed += uint64_t(stop - begin);
+        probe.node->cycles += timed ? read_cycles() - start : 0;
+        return stop;
+    }
+}
+} // namespace detail
+} // namespace arglet
+
+// arglet::detail::snapshot_writer implementation
+// arglet::detail::snapshot_reader implementation
+namespace arglet::detail {
+// Writes the state of a parser tree into a snapshot. The state is written as
+// a sequence of fixed-size fields, and strings are written as an offset and a
+// size into a string pool which follows the state. If no buffers are given,
+// the writer only measures the state and the string pool
+struct snapshot_writer {
+    unsigned char* data = nullptr;
+    size_t data_size = 0;
+    char* pool = nullptr;
+    size_t pool_size = 0;
+
+    void write_bytes(void const* bytes, size_t count) noexcept {
+        if (data) {
+            std::memcpy(data + data_size, bytes, count);
+        }
+        data_size += count;
+    }
+    template <class T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    void write(T value) noexcept {
+        write_bytes(&value, sizeof(T));
+    }
+    void write(std::string_view str) noexcept {
+        write(uint32_t(pool_size));
+        write(uint32_t(str.size()));
+        if (pool) {
+            std::memcpy(pool + pool_size, str.data(), str.size());
+        }
+        pool_size += str.size();
+    }
+    void write(std::string const& str) noexcept {
+        write(std::string_view(str));
+    }
+    template <class T>
+    void write(std::optional<T> const& value) noexcept {
+        write(uint8_t(value.has_value()));
+        if (value) {
+            write(*value);
+        }
+    }
+    template <class T>
+    void write(std::vector<T> const& values) noexcept {
+        write(uint32_t(values.size()));
+        for (auto& value : values) {
+            write(value);
+        }
+    }
+};
+
+// Reads the state of a parser tree from a snapshot. Every read is bounds
+// checked; a read past the end of the state or the string pool marks the
+// reader as bad. Strings are read as views into the string pool, so nothing
+// is copied unless the parser stores std::string
+struct snapshot_reader {
+    unsigned char const* data = nullptr;
+    size_t data_size = 0;
+    char const* pool = nullptr;
+    size_t pool_size = 0;
+    size_t position = 0;
+    bool good = true;
+
+    bool read_bytes(void* bytes, size_t count) noexcept {
+        if (!good || data_size - position < count) {
+            return good = false;
+        }
+        std::memcpy(bytes, data + position, count);
+        position += count;
+        return true;
+    }
+    template <class T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    void read(T& value) noexcept {
+        read_bytes(&value, sizeof(T));
+    }
+    void read(bool& value) noexcept {
+        uint8_t byte = 0;
+        read(byte);
+        good = good && byte <= 1;
+        value = byte == 1;
+    }
+    void read(std::string_view& str) noexcept {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        read(offset);
+        read(size);
+        if (!good || offset > pool_size || pool_size - offset < size) {
+            good = false;
+            return;
+        }
+        str = {pool + offset, size};
+    }
+    void read(std::string& str) {
+        std::string_view view;
+        read(view);
+        str = view;
+    }
+    template <class T>
+    void read(std::optional<T>& value) {
+        bool has_value = false;
+        read(has_value);
+        if (has_value) {
+            read(value.emplace());
+        } else {
+            value.reset();
+        }
+    }
+    template <class T>
+    void read(std::vector<T>& values) {
+        uint32_t size = 0;
+        read(size);
+        // Every element takes up at least one byte, which bounds the size
+        if (!good || size > data_size - position) {
+            good = false;
+            return;
+        }
+        values.clear();
+        values.resize(size);
+        for (auto& value : values) {
+            read(value);
+        }
+    }
+};
+
+// Parsers with state provide write_state and read_state. Parsers without
+// state, such as ignore_arg, are skipped
+template <class Parser>
+void write_state(Parser const& parser, snapshot_writer& out) {
+    if constexpr (requires { parser.write_state(out); }) {
+        parser.write_state(out);
+    }
+}
+template <class Parser>
+void read_state(Parser& parser, snapshot_reader& in) {
+    if constexpr (requires { parser.read_state(in); }) {
+        parser.read_state(in);
+    }
+}
+
+// Hashes the flags and options of a parser tree, in order. Two parser trees
+// of the same type may have different options, such as a command_set whose
+// commands were renamed or reordered, and a snapshot made by one can't be
+// loaded by the other
+struct layout_hasher {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325;
+
+    constexpr void add(char c) noexcept {
+        hash = (hash ^ uint8_t(c)) * 0x100000001b3;
+    }
+    // Each string is followed by a null character, so that "ab" "c" and "a"
+    // "bc" hash differently
+    constexpr void add(std::string_view str) noexcept {
+        for (char c : str) {
+            add(c);
+        }
+        add('\0');
+    }
+};
+
+// Parsers with flags or options provide hash_layout
+template <class Parser>
+constexpr void hash_layout(Parser const& parser, layout_hasher& h) {
+    if constexpr (requires { parser.hash_layout(h); }) {
+        parser.hash_layout(h);
+    }
+}
+} // namespace arglet::detail
+
+// arglet::detail::json_writer implementation
+namespace arglet::detail {
+// Writes the state of a parser tree as the members of a JSON object. Each
+// parser writes one member per value, keyed by the name of its flag. Runs of
+// characters that don't need escaping are copied as a whole. Bytes which
+// aren't part of well-formed UTF-8 are written as U+FFFD, one for each byte,
+// so the output is valid JSON whatever the arguments were
+struct json_writer {
+    text_writer text;
+    bool first = true;
+
+    // Writes the characters of a string, escaped but without quotes
+    constexpr void put_escaped(std::string_view str) noexcept {
+        constexpr char hex[] = "0123456789abcdef";
+        size_t start = 0;
+        size_t invalid = utf8::find_invalid(str);
+        for (size_t i = 0; i < str.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(str[i]);
+            if (i == invalid) {
+                text.put(str.substr(start, i - start));
+                text.put("\\ufffd");
+                start = i + 1;
+                invalid = start + utf8::find_invalid(str.substr(start));
+                continue;
+            }
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            text.put(str.substr(start, i - start));
+            text.put('\\');
+            switch (c) {
+                case '"': text.put('"'); break;
+                case '\\': text.put('\\'); break;
+                case '\n': text.put('n'); break;
+                case '\r': text.put('r'); break;
+                case '\t': text.put('t'); break;
+                default:
+                    text.put("u00");
+                    text.put(hex[c >> 4]);
+                    text.put(hex[c & 0xf]);
+            }
+            start = i + 1;
+        }
+        text.put(str.substr(start));
+    }
+    constexpr void put_string(std::string_view str) noexcept {
+        text.put('"');
+        put_escaped(str);
+        text.put('"');
+    }
+
+    constexpr void key(std::string_view name) noexcept {
+        text.put(first ? "\"" : ",\"");
+        first = false;
+        put_escaped(name);
+        text.put("\":");
+    }
+
+    // Writes a value. Optionals are null when empty, and ranges are arrays.
+    // Values which have no JSON representation are written as null
+    template <class T>
+    constexpr void write(T const& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            text.put(value ? "true" : "false");
+        } else if constexpr (std::is_enum_v<T>) {
+            write(static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            if (value < 0) {
+                text.put('-');
+                text.put_integer(size_t(0) - size_t(value));
+            } else {
+                text.put_integer(size_t(value));
+            }
+        } else if constexpr (std::is_floating_point_v<T>) {
+            // std::to_chars isn't constexpr for floating-point values until
+            // C++23, so these can only be written at runtime
+            char digits[32];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            bool finite = value - value == 0;
+            text.put(
+                finite ? std::string_view(digits, result.ptr) : "null");
+        } else if constexpr (std::is_convertible_v<T, std::string_view>) {
+            put_string(value);
+        } else if constexpr (traits::is_optional_v<T>) {
+            value ? write(*value) : text.put("null");
+        } else if constexpr (requires { std::string_view(value.native()); }) {
+            // Paths are written as strings, rather than as their components
+            put_string(value.native());
+        } else if constexpr (requires { value.begin() != value.end(); }) {
+            text.put('[');
+            bool first_elem = true;
+            for (auto const& elem : value) {
+                first_elem ? void() : text.put(',');
+                first_elem = false;
+                write(elem);
+            }
+            text.put(']');
+        } else {
+            text.put("null");
+        }
+    }
+
+    template <class T>
+    constexpr void member(std::string_view name, T const& value) {
+        key(name);
+        write(value);
+    }
+};
+
+// True if the tag names its value with a static member, name
+template <class Tag>
+constexpr bool has_json_name = requires { std::string_view(Tag::name); };
+
+// The name a parser's value is written under: the name given by the tag, or
+// otherwise the name of the flag
+template <class Tag>
+constexpr std::string_view json_name(std::string_view flag_name) noexcept {
+    if constexpr (has_json_name<Tag>) {
+        return Tag::name;
+    } else {
+        return flag_name;
+    }
+}
+// The name of a value without a flag of its own, such as a positional value
+// or a command. Any default would be shared by every such parser in the
+// tree, so the tag has to give the name
+template <class Tag>
+constexpr std::string_view json_name() noexcept {
+    static_assert(
+        has_json_name<Tag>,
+        "a parser without a flag needs a tag with a name to be written as "
+        "JSON");
+    return Tag::name;
+}
+
+// Parsers write their members with write_json. Parsers without a value, such
+// as ignore_arg, are skipped
+template <class Parser>
+constexpr void write_json(Parser const& parser, json_writer& out) {
+    if constexpr (requires { parser.write_json(out); }) {
+        parser.write_json(out);
+    }
+}
+} // namespace arglet::detail
+
 // arglet::flag_matcher
 namespace arglet {
+namespace detail {
+// The name of a long flag, without its leading dashes or a trailing '='
+constexpr std::string_view flag_name(std::string_view form) noexcept {
+    form.remove_prefix(std::min(form.find_first_not_of('-'), form.size()));
+    if (form.ends_with('=')) {
+        form.remove_suffix(1);
+    }
+    return form;
+}
+} // namespace detail
+
 template <flag_form form>
 struct flag_matcher;
 
@@ -141,6 +743,21 @@ struct flag_matcher<flag_form::Short> {
         return arg.size() == 2 && arg[0] == '-' && arg[1] == short_form;
     }
 
+    // Writes the flag as it appears on the command line, followed by suffix
+    constexpr void write_forms(
+        detail::text_writer& out,
+        std::string_view,
+        std::string_view suffix = {}) const noexcept {
+        out.put('-');
+        out.put(short_form);
+        out.put(suffix);
+    }
+
+    // The name of the flag, without its dash
+    constexpr std::string_view name() const noexcept {
+        return {&short_form, 1};
+    }
+
     template <class Value, class NewValue = Value>
     constexpr bool parse_char(char c, Value& value, NewValue&& new_value) const
         noexcept(std::is_nothrow_assignable_v<Value&, NewValue>) {
@@ -175,6 +792,20 @@ struct flag_matcher<flag_form::Long> {
         return false;
     }
 
+    // Writes the flag as it appears on the command line, followed by suffix
+    constexpr void write_forms(
+        detail::text_writer& out,
+        std::string_view,
+        std::string_view suffix = {}) const noexcept {
+        out.put(long_form);
+        out.put(suffix);
+    }
+
+    // The name of the flag, without its dashes
+    constexpr std::string_view name() const noexcept {
+        return detail::flag_name(long_form);
+    }
+
     constexpr bool parse_char(
         util::ignore_function_arg,
         util::ignore_function_arg,
@@ -230,6 +861,25 @@ struct flag_matcher<flag_form::Both> {
         return arg.size() == 2 && arg[0] == '-' && arg[1] == short_form;
     }
 
+    // Writes both forms of the flag as they appear on the command line,
+    // separated by separator. Each form is followed by suffix
+    constexpr void write_forms(
+        detail::text_writer& out,
+        std::string_view separator,
+        std::string_view suffix = {}) const noexcept {
+        out.put('-');
+        out.put(short_form);
+        out.put(suffix);
+        out.put(separator);
+        out.put(long_form);
+        out.put(suffix);
+    }
+
+    // The name of the long form, without its dashes
+    constexpr std::string_view name() const noexcept {
+        return detail::flag_name(long_form);
+    }
+
     template <class Value, class NewValue = Value>
     constexpr bool parse_char(char c, Value& value, NewValue&& new_value) const
         noexcept(std::is_nothrow_assignable_v<Value&, NewValue>) {
@@ -265,6 +915,20 @@ struct flag_matcher<flag_form::Both> {
 };
 } // namespace arglet
 
+namespace arglet::detail {
+// Adds the forms of a flag to a layout hash
+template <flag_form form>
+constexpr void
+hash_matcher(flag_matcher<form> const& matcher, layout_hasher& h) noexcept {
+    if constexpr (form != flag_form::Long) {
+        h.add(matcher.short_form);
+    }
+    if constexpr (form != flag_form::Short) {
+        h.add(matcher.long_form);
+    }
+}
+} // namespace arglet::detail
+
 // arglet::flag implementation
 namespace arglet {
 template <class Tag, flag_form form>
@@ -284,14 +948,32 @@ struct flag {
     constexpr intptr_t parse(int argc, char const** argv) {
         return parse(argv, argv + argc) - argv;
     }
-    bool& operator[](Tag) { return value; }
-    bool const& operator[](Tag) const { return value; }
+    constexpr bool& operator[](Tag) { return value; }
+    constexpr bool const& operator[](Tag) const { return value; }
     constexpr bool parse_char(char c) noexcept {
         return matcher.parse_char(c, value, true);
     }
     constexpr bool parse_long_form(const char* arg) noexcept {
         return matcher.parse_long_form(arg, value, true);
     }
+    constexpr void write_usage(detail::text_writer& out) const {
+        out.put(" [");
+        matcher.write_forms(out, "|");
+        out.put(']');
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        out.put("  ");
+        matcher.write_forms(out, ", ");
+        out.put('\n');
+    }
+    void write_state(detail::snapshot_writer& out) const { out.write(value); }
+    void read_state(detail::snapshot_reader& in) { in.read(value); }
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        detail::hash_matcher(matcher, h);
+    }
+    constexpr void write_json(detail::json_writer& out) const {
+        out.member(detail::json_name<Tag>(matcher.name()), value);
+    }
 };
 template <class Tag>
 flag(Tag tag, char) -> flag<Tag, flag_form::Short>;
@@ -319,46 +1001,65 @@ constexpr ignore_arg_t ignore_arg = {};
 
 // arglet::parse_value implementation
 namespace arglet {
-std::true_type
+namespace detail {
+// Parses a base-10 integer. Fails on empty input, on trailing characters, and
+// on values that don't fit in T. Unlike std::from_chars (prior to C++23), this
+// may be used in constant evaluation
+template <class T>
+constexpr bool parse_integer(std::string_view arg, T& value) noexcept {
+    size_t i = 0;
+    bool negative = false;
+    if constexpr (std::is_signed_v<T>) {
+        if (arg.size() > 0 && arg[0] == '-') {
+            negative = true;
+            i = 1;
+        }
+    }
+    if (i == arg.size()) {
+        return false;
+    }
+    T result = 0;
+    for (; i < arg.size(); i++) {
+        char c = arg[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        T digit = c - '0';
+        if (negative) {
+            if (result < (std::numeric_limits<T>::min() + digit) / 10) {
+                return false;
+            }
+            result = result * 10 - digit;
+        } else {
+            if (result > (std::numeric_limits<T>::max() - digit) / 10) {
+                return false;
+            }
+            result = result * 10 + digit;
+        }
+    }
+    value = result;
+    return true;
+}
+} // namespace detail
+
+constexpr std::true_type
 parse_value(std::string_view arg, std::string_view& value) noexcept {
     value = arg;
     return {};
 }
-bool parse_value(std::string_view arg, std::int32_t& value) noexcept {
-    auto [end, errc] =
-        std::from_chars(arg.data(), arg.data() + arg.size(), value);
-    if (end == arg.data() + arg.size()) {
-        return true;
-    } else {
-        return false;
-    }
+constexpr bool parse_value(std::string_view arg, std::int32_t& value) noexcept {
+    return detail::parse_integer(arg, value);
 }
-bool parse_value(std::string_view arg, std::uint32_t& value) noexcept {
-    auto [end, errc] =
-        std::from_chars(arg.data(), arg.data() + arg.size(), value);
-    if (end == arg.data() + arg.size()) {
-        return true;
-    } else {
-        return false;
-    }
+constexpr bool
+parse_value(std::string_view arg, std::uint32_t& value) noexcept {
+    return detail::parse_integer(arg, value);
 }
-bool parse_value(std::string_view arg, std::int64_t& value) noexcept {
-    auto [end, errc] =
-        std::from_chars(arg.data(), arg.data() + arg.size(), value);
-    if (end == arg.data() + arg.size()) {
-        return true;
-    } else {
-        return false;
-    }
+constexpr bool parse_value(std::string_view arg, std::int64_t& value) noexcept {
+    return detail::parse_integer(arg, value);
 }
-bool parse_value(std::string_view arg, std::uint64_t& value) noexcept {
-    auto [end, errc] =
-        std::from_chars(arg.data(), arg.data() + arg.size(), value);
-    if (end == arg.data() + arg.size()) {
-        return true;
-    } else {
-        return false;
-    }
+constexpr bool
+parse_value(std::string_view arg, std::uint64_t& value) noexcept {
+    return detail::parse_integer(arg, value);
 }
 template <class T>
 constexpr std::true_type parse_value(std::string_view arg, T& value) noexcept(
@@ -367,7 +1068,7 @@ constexpr std::true_type parse_value(std::string_view arg, T& value) noexcept(
     return {};
 }
 template <class T>
-auto parse_value(std::string_view arg, std::optional<T>& value) {
+constexpr auto parse_value(std::string_view arg, std::optional<T>& value) {
     if constexpr (std::is_constructible_v<T, std::string_view>) {
         value.emplace(arg);
         return std::true_type {};
@@ -381,7 +1082,7 @@ auto parse_value(std::string_view arg, std::optional<T>& value) {
     }
 }
 template <class T>
-auto parse_value(std::string_view arg, std::vector<T>& value) {
+constexpr auto parse_value(std::string_view arg, std::vector<T>& value) {
     if constexpr (std::is_constructible_v<T, std::string_view>) {
         value.emplace_back(arg);
         return std::true_type {};
@@ -409,7 +1110,8 @@ constexpr auto parse_value(std::string_view arg, Func& func, T& value) {
     }
 }
 template <class Func, class T>
-auto parse_value(std::string_view arg, Func& func, std::optional<T>& value) {
+constexpr auto
+parse_value(std::string_view arg, Func& func, std::optional<T>& value) {
     if constexpr (traits::is_optional_v<decltype(func(arg))>) {
         if (auto result = func(arg)) {
             value.emplace(*std::move(result));
@@ -423,7 +1125,8 @@ auto parse_value(std::string_view arg, Func& func, std::optional<T>& value) {
     }
 }
 template <class Func, class T>
-auto parse_value(std::string_view arg, Func& func, std::vector<T>& value) {
+constexpr auto
+parse_value(std::string_view arg, Func& func, std::vector<T>& value) {
     if constexpr (traits::is_optional_v<decltype(func(arg))>) {
         if (auto result = func(arg)) {
             value.emplace_back(*std::move(result));
@@ -502,49 +1205,288 @@ template <class EorF>
 using deduce_parser_t = typename deduce_parser<EorF>::type;
 }; // namespace arglet
 
-// arglet::value implementation
+// arglet::lazy_value_parser implementation
+// arglet::lazy implementation
 namespace arglet {
-template <class Tag, class Parser>
-struct value {
-    [[no_unique_address]] Tag tag;
-    Parser parser;
-    char const** parse(char const** begin, const char** end) {
-        return begin + (bool)parser.parse(begin[0]);
+namespace detail {
+// Stands in for the converter of a lazy_value_parser that uses parse_value
+struct no_converter {};
+
+template <class Elem>
+constexpr bool is_vector = false;
+template <class T>
+constexpr bool is_vector<std::vector<T>> = true;
+
+// Collects the errors found by validate_all
+struct validator {
+    int argc = 0;
+    char const** argv = nullptr;
+    diagnostic* diag = nullptr;
+    bool valid = true;
+
+    template <class Parser>
+    void check(Parser const& parser, std::string_view parser_name) {
+        if constexpr (requires { parser.invalid_token(); }) {
+            if (auto token = parser.invalid_token()) {
+                valid = false;
+                record(*token, parser_name);
+            }
+        }
     }
-    constexpr intptr_t parse(int argc, char const** argv) {
-        return parse(argv, argv + argc) - argv;
+
+    // Finds the argument which contains the token, so that the error is
+    // reported at the same position as it would have been while parsing
+    void record(std::string_view token, std::string_view parser_name) {
+        std::less<char const*> less;
+        for (int i = 0; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (!less(token.data(), arg.data())
+                && !less(arg.data() + arg.size(), token.data())) {
+                diag->record(
+                    error_kind::invalid_value,
+                    argv + i,
+                    size_t(token.data() - arg.data()),
+                    parser_name);
+                return;
+            }
+        }
+        if (!*diag) {
+            diag->kind = error_kind::invalid_value;
+            diag->arg_index = -1;
+            diag->token = token;
+            diag->parser = parser_name;
+        }
     }
-    auto& operator[](Tag) { return parser.value; }
-    auto const& operator[](Tag) const { return parser.value; }
 };
 
-template <class Tag, class Arg>
-value(Tag, Arg) -> value<Tag, deduce_parser_t<Arg>>;
-template <class Tag, class Elem, class Func>
-value(Tag, Elem, Func) -> value<Tag, value_parser<Elem, Func>>;
-} // namespace arglet
+template <class Parser>
+void validate(Parser const& parser, validator& v) {
+    if constexpr (requires { parser.validate(v); }) {
+        parser.validate(v);
+    }
+}
 
-// arglet::value_flag implementation
-namespace arglet {
-template <class Tag, flag_form form, class Parser>
-struct value_flag {
-    [[no_unique_address]] Tag tag;
-    flag_matcher<form> matcher;
-    Parser parser;
+// Returns the value held by a value parser. Lazy parsers convert their tokens
+// the first time the value is accessed
+template <class Parser>
+constexpr auto& get_value(Parser& parser) {
+    if constexpr (requires { parser.get(); }) {
+        return parser.get();
+    } else {
+        return parser.value;
+    }
+}
+} // namespace detail
 
-    constexpr char const** parse(char const** begin, char const** end) {
-        if ((end - begin) >= 2 && matcher.matches(begin[0])) {
-            if (parser.parse(begin[1])) {
-                return begin + 2;
+// A value parser which accepts every token, and only converts it when the
+// value is first accessed. The converted value is cached. Tokens that can't be
+// converted leave the value unchanged; use validate_all to report them.
+//
+// Tokens are views into argv, so argv must outlive the parser. If Elem is a
+// std::vector, every token is kept and converted. Because every token is
+// accepted, a lazy item takes every remaining argument, including ones an
+// eager item would stop at.
+//
+// Conversion happens on first access, even through a const reference, so a
+// parser holding lazy values isn't safe to read from several threads at once.
+// Call validate_all first to convert every value; after that, reads don't
+// modify the parser.
+template <class Elem, class Func = detail::no_converter>
+struct lazy_value_parser {
+    using token_list = std::conditional_t<
+        detail::is_vector<Elem>,
+        std::vector<std::string_view>,
+        std::optional<std::string_view>>;
+
+    [[no_unique_address]] mutable Func func;
+    mutable Elem value {};
+    token_list tokens {};
+    // Number of tokens which have been converted
+    mutable size_t num_converted = 0;
+    // First token which couldn't be converted
+    mutable std::optional<std::string_view> invalid {};
+
+    constexpr std::true_type parse(std::string_view arg) {
+        if constexpr (detail::is_vector<Elem>) {
+            tokens.push_back(arg);
+        } else {
+            tokens = arg;
+            num_converted = 0;
+        }
+        return {};
+    }
+
+    constexpr Elem& get() const {
+        if constexpr (detail::is_vector<Elem>) {
+            for (; num_converted < tokens.size(); num_converted++) {
+                convert(tokens[num_converted]);
             }
+        } else if (tokens && num_converted == 0) {
+            num_converted = 1;
+            invalid.reset();
+            convert(*tokens);
         }
-        return begin;
+        return value;
     }
-    constexpr intptr_t parse(int argc, char const** argv) {
-        return parse(argv, argv + argc) - argv;
+
+    // Converts the value if it hasn't been converted yet, and returns the
+    // first token that couldn't be converted, if any
+    constexpr std::optional<std::string_view> invalid_token() const {
+        get();
+        return invalid;
+    }
+
+   private:
+    constexpr void convert(std::string_view token) const {
+        bool converted;
+        if constexpr (std::is_same_v<Func, detail::no_converter>) {
+            converted = bool(parse_value(token, value));
+        } else {
+            converted = bool(parse_value(token, func, value));
+        }
+        if (!converted && !invalid) {
+            invalid = token;
+        }
+    }
+};
+
+// Marks a value for lazy conversion. The argument is either the default value,
+// which is converted with parse_value, or a converter, as with value_flag:
+//
+//     value_flag {tags::config, "--config", lazy(load_config)}
+template <class EorF>
+constexpr auto lazy(EorF value_or_func) {
+    if constexpr (std::is_invocable_v<EorF, std::string_view>) {
+        using elem_t = traits::wrap_optional<
+            std::invoke_result_t<EorF, std::string_view>>;
+        return lazy_value_parser<elem_t, EorF> {std::move(value_or_func)};
+    } else {
+        return lazy_value_parser<EorF> {{}, std::move(value_or_func)};
+    }
+}
+// Marks a value for lazy conversion with the given converter
+template <class Elem, class Func>
+constexpr auto lazy(Elem value, Func func) {
+    return lazy_value_parser<Elem, Func> {std::move(func), std::move(value)};
+}
+
+template <class Elem, class Func>
+struct deduce_parser<lazy_value_parser<Elem, Func>> {
+    using type = lazy_value_parser<Elem, Func>;
+};
+
+// Converts every lazy value in the parser, and returns true if every token
+// could be converted. Otherwise diag describes a token that couldn't be; as
+// with parse, the one furthest into argv is reported. Parsers which convert
+// eagerly have already been validated by parse, and are skipped
+template <class Parser>
+bool validate_all(
+    Parser const& parser, int argc, char const** argv, diagnostic& diag) {
+    diag = diagnostic {.argv = argv};
+    detail::validator v {argc, argv, &diag};
+    detail::validate(parser, v);
+    diag.argv = nullptr;
+    return v.valid;
+}
+} // namespace arglet
+
+// arglet::value implementation
+namespace arglet {
+template <class Tag, class Parser>
+struct value {
+    [[no_unique_address]] Tag tag;
+    Parser parser;
+    constexpr char const** parse(char const** begin, const char**) {
+        return begin + (bool)parser.parse(begin[0]);
+    }
+    constexpr intptr_t parse(int argc, char const** argv) {
+        return parse(argv, argv + argc) - argv;
+    }
+    constexpr auto& operator[](Tag) { return detail::get_value(parser); }
+    constexpr auto const& operator[](Tag) const {
+        return detail::get_value(parser);
+    }
+    constexpr void write_usage(detail::text_writer& out) const {
+        out.put(" <value>");
+    }
+    void write_state(detail::snapshot_writer& out) const {
+        out.write(detail::get_value(parser));
+    }
+    void validate(detail::validator& v) const { v.check(parser, "value"); }
+    void read_state(detail::snapshot_reader& in) { in.read(parser.value); }
+    // Positional values have no flag, so they're named by their tag
+    constexpr void write_json(detail::json_writer& out) const {
+        out.member(detail::json_name<Tag>(), detail::get_value(parser));
+    }
+};
+
+template <class Tag, class Arg>
+value(Tag, Arg) -> value<Tag, deduce_parser_t<Arg>>;
+template <class Tag, class Elem, class Func>
+value(Tag, Elem, Func) -> value<Tag, value_parser<Elem, Func>>;
+} // namespace arglet
+
+// arglet::value_flag implementation
+namespace arglet {
+template <class Tag, flag_form form, class Parser>
+struct value_flag {
+    [[no_unique_address]] Tag tag;
+    flag_matcher<form> matcher;
+    Parser parser;
+
+    constexpr char const** parse(char const** begin, char const** end) {
+        diagnostic diag {.argv = begin};
+        return parse(begin, end, diag);
+    }
+    constexpr char const**
+    parse(char const** begin, char const** end, diagnostic& diag) {
+        if (begin != end && matcher.matches(begin[0])) {
+            if (end - begin < 2) {
+                diag.record(
+                    error_kind::missing_value,
+                    begin,
+                    std::string_view(begin[0]).size(),
+                    "value_flag");
+            } else if (parser.parse(begin[1])) {
+                return begin + 2;
+            } else {
+                diag.record(
+                    error_kind::invalid_value, begin + 1, 0, "value_flag");
+            }
+        }
+        return begin;
+    }
+    constexpr intptr_t parse(int argc, char const** argv) {
+        return parse(argv, argv + argc) - argv;
+    }
+    constexpr auto& operator[](Tag) { return detail::get_value(parser); }
+    constexpr auto const& operator[](Tag) const {
+        return detail::get_value(parser);
+    }
+    constexpr void write_usage(detail::text_writer& out) const {
+        out.put(" [");
+        matcher.write_forms(out, "|");
+        out.put(" <value>]");
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        out.put("  ");
+        matcher.write_forms(out, ", ", " <value>");
+        out.put('\n');
+    }
+    void write_state(detail::snapshot_writer& out) const {
+        out.write(detail::get_value(parser));
+    }
+    void validate(detail::validator& v) const {
+        v.check(parser, "value_flag");
+    }
+    void read_state(detail::snapshot_reader& in) { in.read(parser.value); }
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        detail::hash_matcher(matcher, h);
+    }
+    constexpr void write_json(detail::json_writer& out) const {
+        out.member(
+            detail::json_name<Tag>(matcher.name()), detail::get_value(parser));
     }
-    auto& operator[](Tag) { return parser.value; }
-    auto const& operator[](Tag) const { return parser.value; }
 };
 template <class Tag, class Arg>
 value_flag(Tag, char, Arg)
@@ -567,6 +1509,193 @@ value_flag(Tag, char, string_literal<N>, Elem, Func)
     -> value_flag<Tag, flag_form::Both, value_parser<Elem, Func>>;
 } // namespace arglet
 
+// arglet::multi_value_flag implementation
+namespace arglet {
+namespace detail {
+// True if the argument is a decimal number, such as "12", "0.5" or "1e-3"
+constexpr bool is_number(char const* arg) noexcept {
+    auto digits = [&] {
+        char const* start = arg;
+        while (*arg >= '0' && *arg <= '9') {
+            arg++;
+        }
+        return arg != start;
+    };
+    bool has_digits = digits();
+    if (*arg == '.') {
+        arg++;
+        has_digits = digits() || has_digits;
+    }
+    if (has_digits && (*arg == 'e' || *arg == 'E')) {
+        arg++;
+        if (*arg == '+' || *arg == '-') {
+            arg++;
+        }
+        has_digits = digits();
+    }
+    return has_digits && *arg == '\0';
+}
+
+// True if the argument looks like a flag. A lone "-" is a value, since it
+// conventionally names stdin or stdout, and so is a negative number
+constexpr bool is_flag_like(char const* arg) noexcept {
+    return arg[0] == '-' && arg[1] != '\0' && !is_number(arg + 1);
+}
+
+// Returns the values held by a parser whose values are a std::vector. Lazy
+// parsers hold their tokens until they're accessed
+template <class Parser>
+constexpr auto& stored_values(Parser& parser) {
+    if constexpr (requires { parser.tokens.reserve(0); }) {
+        return parser.tokens;
+    } else {
+        return parser.value;
+    }
+}
+} // namespace detail
+
+// A flag followed by one or more values, which are appended to a vector:
+//
+//     multi_value_flag {tags::include, 'I', "--include", std::vector<path>()}
+//
+// accepts `--include a b c`. Values are taken up to the next argument which
+// looks like a flag, so "--" ends the list. They're all consumed in a single
+// call, so a long list isn't passed back through the enclosing group one value
+// at a time. The flag may be repeated, in which case the values accumulate.
+//
+// Negative numbers, such as -1 or -2.5, are taken as values. The other
+// parsers in the group aren't consulted, so a short flag named by a digit,
+// like -1, is taken as a value when it comes right after the list; give it
+// before the multi_value_flag instead.
+template <class Tag, flag_form form, class Parser>
+struct multi_value_flag {
+    [[no_unique_address]] Tag tag;
+    flag_matcher<form> matcher;
+    Parser parser;
+
+    constexpr char const** parse(char const** begin, char const** end) {
+        diagnostic diag {.argv = begin};
+        return parse(begin, end, diag);
+    }
+    constexpr char const**
+    parse(char const** begin, char const** end, diagnostic& diag) {
+        if (begin == end || !matcher.matches(begin[0])) {
+            return begin;
+        }
+        char const** values = begin + 1;
+        char const** stop = values;
+        while (stop != end && !detail::is_flag_like(*stop)) {
+            stop++;
+        }
+        if (stop == values) {
+            diag.record(
+                error_kind::missing_value,
+                begin,
+                std::string_view(begin[0]).size(),
+                "multi_value_flag");
+            return begin;
+        }
+        auto& stored = detail::stored_values(parser);
+        size_t old_size = stored.size();
+        // Capacity grows geometrically, so a flag repeated many times doesn't
+        // reallocate the vector every time
+        size_t needed = old_size + size_t(stop - values);
+        if (needed > stored.capacity()) {
+            stored.reserve(std::max(needed, 2 * stored.capacity()));
+        }
+        for (; values != stop; values++) {
+            if (!parser.parse(values[0])) {
+                // As with value_flag, nothing is kept if a value is invalid
+                stored.erase(stored.begin() + old_size, stored.end());
+                diag.record(
+                    error_kind::invalid_value, values, 0, "multi_value_flag");
+                return begin;
+            }
+        }
+        return stop;
+    }
+    constexpr intptr_t parse(int argc, char const** argv) {
+        return parse(argv, argv + argc) - argv;
+    }
+    constexpr auto& operator[](Tag) { return detail::get_value(parser); }
+    constexpr auto const& operator[](Tag) const {
+        return detail::get_value(parser);
+    }
+    constexpr void write_usage(detail::text_writer& out) const {
+        out.put(" [");
+        matcher.write_forms(out, "|");
+        out.put(" <value>...]");
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        out.put("  ");
+        matcher.write_forms(out, ", ", " <value>...");
+        out.put('\n');
+    }
+    void write_state(detail::snapshot_writer& out) const {
+        out.write(detail::get_value(parser));
+    }
+    void validate(detail::validator& v) const {
+        v.check(parser, "multi_value_flag");
+    }
+    void read_state(detail::snapshot_reader& in) { in.read(parser.value); }
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        detail::hash_matcher(matcher, h);
+    }
+    constexpr void write_json(detail::json_writer& out) const {
+        out.member(
+            detail::json_name<Tag>(matcher.name()), detail::get_value(parser));
+    }
+};
+template <class Tag, class Elem>
+multi_value_flag(Tag, char, std::vector<Elem>)
+    -> multi_value_flag<Tag, flag_form::Short, value_parser<std::vector<Elem>>>;
+template <class Tag, size_t N, class Elem>
+multi_value_flag(Tag, string_literal<N>, std::vector<Elem>)
+    -> multi_value_flag<Tag, flag_form::Long, value_parser<std::vector<Elem>>>;
+template <class Tag, size_t N, class Elem>
+multi_value_flag(Tag, char, string_literal<N>, std::vector<Elem>)
+    -> multi_value_flag<Tag, flag_form::Both, value_parser<std::vector<Elem>>>;
+
+template <class Tag, class Elem, class Func>
+multi_value_flag(Tag, char, std::vector<Elem>, Func) -> multi_value_flag<
+    Tag,
+    flag_form::Short,
+    value_parser<std::vector<Elem>, Func>>;
+template <class Tag, size_t N, class Elem, class Func>
+multi_value_flag(Tag, string_literal<N>, std::vector<Elem>, Func)
+    -> multi_value_flag<
+        Tag,
+        flag_form::Long,
+        value_parser<std::vector<Elem>, Func>>;
+template <class Tag, size_t N, class Elem, class Func>
+multi_value_flag(Tag, char, string_literal<N>, std::vector<Elem>, Func)
+    -> multi_value_flag<
+        Tag,
+        flag_form::Both,
+        value_parser<std::vector<Elem>, Func>>;
+
+template <class Tag, class Elem, class Func>
+multi_value_flag(Tag, char, lazy_value_parser<std::vector<Elem>, Func>)
+    -> multi_value_flag<
+        Tag,
+        flag_form::Short,
+        lazy_value_parser<std::vector<Elem>, Func>>;
+template <class Tag, size_t N, class Elem, class Func>
+multi_value_flag(
+    Tag, string_literal<N>, lazy_value_parser<std::vector<Elem>, Func>)
+    -> multi_value_flag<
+        Tag,
+        flag_form::Long,
+        lazy_value_parser<std::vector<Elem>, Func>>;
+template <class Tag, size_t N, class Elem, class Func>
+multi_value_flag(
+    Tag, char, string_literal<N>, lazy_value_parser<std::vector<Elem>, Func>)
+    -> multi_value_flag<
+        Tag,
+        flag_form::Both,
+        lazy_value_parser<std::vector<Elem>, Func>>;
+} // namespace arglet
+
 // arglet::prefixed_value implementation
 namespace arglet {
 template <class Tag, flag_form form, class Parser>
@@ -576,18 +1705,42 @@ struct prefixed_value {
     Parser parser;
 
     constexpr char const** parse(char const** begin, char const** end) {
+        diagnostic diag {.argv = begin};
+        return parse(begin, end, diag);
+    }
+    constexpr char const**
+    parse(char const** begin, char const** end, diagnostic& diag) {
         std::string_view flag = begin[0];
-        if (matcher.matches_short_form(flag) && (end - begin) >= 2) {
-            if (parser.parse(std::string_view(begin[1]))) {
+        if (matcher.matches_short_form(flag)) {
+            if (end - begin < 2) {
+                diag.record(
+                    error_kind::missing_value,
+                    begin,
+                    flag.size(),
+                    "prefixed_value");
+            } else if (parser.parse(std::string_view(begin[1]))) {
                 return begin + 2;
             } else {
-                return begin;
+                diag.record(
+                    error_kind::invalid_value, begin + 1, 0, "prefixed_value");
             }
+            return begin;
         }
         if (size_t prefix_size = matcher.match_prefix(flag)) {
-            if (prefix_size < flag.size()
-                && parser.parse(flag.substr(prefix_size))) {
+            if (prefix_size == flag.size()) {
+                diag.record(
+                    error_kind::missing_value,
+                    begin,
+                    prefix_size,
+                    "prefixed_value");
+            } else if (parser.parse(flag.substr(prefix_size))) {
                 return begin + 1;
+            } else {
+                diag.record(
+                    error_kind::invalid_value,
+                    begin,
+                    prefix_size,
+                    "prefixed_value");
             }
         }
         return begin;
@@ -595,8 +1748,34 @@ struct prefixed_value {
     constexpr intptr_t parse(int argc, char const** argv) {
         return parse(argv, argv + argc) - argv;
     }
-    auto& operator[](Tag) { return parser.value; }
-    auto const& operator[](Tag) const { return parser.value; }
+    constexpr auto& operator[](Tag) { return detail::get_value(parser); }
+    constexpr auto const& operator[](Tag) const {
+        return detail::get_value(parser);
+    }
+    constexpr void write_usage(detail::text_writer& out) const {
+        out.put(" [");
+        matcher.write_forms(out, "|", "<value>");
+        out.put(']');
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        out.put("  ");
+        matcher.write_forms(out, ", ", "<value>");
+        out.put('\n');
+    }
+    void write_state(detail::snapshot_writer& out) const {
+        out.write(detail::get_value(parser));
+    }
+    void validate(detail::validator& v) const {
+        v.check(parser, "prefixed_value");
+    }
+    void read_state(detail::snapshot_reader& in) { in.read(parser.value); }
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        detail::hash_matcher(matcher, h);
+    }
+    constexpr void write_json(detail::json_writer& out) const {
+        out.member(
+            detail::json_name<Tag>(matcher.name()), detail::get_value(parser));
+    }
 };
 template <class Tag, class Arg>
 prefixed_value(Tag, char, Arg)
@@ -625,6 +1804,10 @@ template <class Tag, class Parser>
 struct item : value<Tag, Parser> {
     using value<Tag, Parser>::parse;
     using value<Tag, Parser>::operator[];
+    constexpr void write_usage(detail::text_writer& out) const {
+        out.put(" [<value>...]");
+    }
+    void validate(detail::validator& v) const { v.check(this->parser, "item"); }
 };
 template <class Tag, class Elem>
 item(Tag, std::vector<Elem>)
@@ -640,6 +1823,9 @@ item(Tag, F) -> item<
 template <class Tag, class Elem, class Func>
 item(Tag, std::vector<Elem>, Func)
     -> item<Tag, value_parser<std::vector<Elem>, Func>>;
+template <class Tag, class Elem, class Func>
+item(Tag, lazy_value_parser<std::vector<Elem>, Func>)
+    -> item<Tag, lazy_value_parser<std::vector<Elem>, Func>>;
 } // namespace arglet
 
 // arglet::string implementation
@@ -663,7 +1849,7 @@ struct option {
     flag_matcher<type> matcher;
     T option_value {};
     template <class U>
-    bool match_assign(std::string_view arg, U& value) {
+    constexpr bool match_assign(std::string_view arg, U& value) {
         if (matcher.matches(arg)) {
             value = option_value;
             return true;
@@ -682,6 +1868,32 @@ struct option {
     }
 };
 
+namespace detail {
+// Writes the forms of every option, separated by "|"
+template <class Options, size_t... I>
+constexpr void write_option_usage(
+    Options const& options, text_writer& out, std::index_sequence<I...>) {
+    (((I > 0 ? out.put('|') : void()),
+      options[tag_v<I>].matcher.write_forms(out, "|")),
+     ...);
+}
+// Adds the forms of every option, in order, to a layout hash
+template <class Options, size_t... I>
+constexpr void hash_options(
+    Options const& options, layout_hasher& h, std::index_sequence<I...>) {
+    (hash_matcher(options[tag_v<I>].matcher, h), ...);
+}
+// Writes a line for each option
+template <class Options, size_t... I>
+constexpr void write_option_help(
+    Options const& options, text_writer& out, std::index_sequence<I...>) {
+    ((out.put("  "),
+      options[tag_v<I>].matcher.write_forms(out, ", "),
+      out.put('\n')),
+     ...);
+}
+} // namespace detail
+
 template <class T>
 option(char, T) -> option<T, flag_form::Short>;
 template <size_t N, class T>
@@ -700,6 +1912,28 @@ template <class... Arg>
 struct sequence : Arg... {
     using Arg::operator[]...;
 
+    constexpr void write_usage(detail::text_writer& out) const {
+        (detail::write_usage(static_cast<Arg const&>(*this), out), ...);
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        (detail::write_help(static_cast<Arg const&>(*this), out), ...);
+    }
+    void write_state(detail::snapshot_writer& out) const {
+        (detail::write_state(static_cast<Arg const&>(*this), out), ...);
+    }
+    constexpr void write_json(detail::json_writer& out) const {
+        (detail::write_json(static_cast<Arg const&>(*this), out), ...);
+    }
+    void read_state(detail::snapshot_reader& in) {
+        (detail::read_state(static_cast<Arg&>(*this), in), ...);
+    }
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        (detail::hash_layout(static_cast<Arg const&>(*this), h), ...);
+    }
+    void validate(detail::validator& v) const {
+        (detail::validate(static_cast<Arg const&>(*this), v), ...);
+    }
+
     constexpr char const** parse(char const** begin, char const** end) {
         // this is cast to void because we don't need the result of this
         // fold expression. Casting it to void prevents an unused value warning
@@ -708,9 +1942,46 @@ struct sequence : Arg... {
         }
         return begin;
     }
+    constexpr char const**
+    parse(char const** begin, char const** end, diagnostic& diag) {
+        if (begin != end) {
+            (void)((begin = detail::parse_with<Arg>(*this, begin, end, diag),
+                    begin != end)
+                   && ...);
+        }
+        return begin;
+    }
+    // Parses with an instrumentation probe, which is passed on to every child
+    template <class Probe>
+    constexpr char const** parse(
+        char const** begin, char const** end, diagnostic& diag, Probe probe) {
+        if (begin != end) {
+            parse_(begin, end, diag, probe, indicies);
+        }
+        return begin;
+    }
     constexpr intptr_t parse(int argc, char const** argv) {
         return parse(argv, argv + argc) - argv;
     }
+
+   private:
+    constexpr static auto indicies = std::index_sequence_for<Arg...>();
+    template <class Probe, size_t... I>
+    constexpr void parse_(
+        char const**& begin,
+        char const** end,
+        diagnostic& diag,
+        Probe probe,
+        std::index_sequence<I...>) {
+        (void)((begin = detail::parse_with<Arg>(
+                    *this,
+                    begin,
+                    end,
+                    diag,
+                    probe.template child<detail::child_offset<I, Arg...>>()),
+                begin != end)
+               && ...);
+    }
 };
 template <class... Arg>
 sequence(Arg...) -> sequence<Arg...>;
@@ -722,6 +1993,28 @@ template <class... Arg>
 struct group : Arg... {
     using Arg::operator[]...;
 
+    constexpr void write_usage(detail::text_writer& out) const {
+        (detail::write_usage(static_cast<Arg const&>(*this), out), ...);
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        (detail::write_help(static_cast<Arg const&>(*this), out), ...);
+    }
+    void write_state(detail::snapshot_writer& out) const {
+        (detail::write_state(static_cast<Arg const&>(*this), out), ...);
+    }
+    constexpr void write_json(detail::json_writer& out) const {
+        (detail::write_json(static_cast<Arg const&>(*this), out), ...);
+    }
+    void read_state(detail::snapshot_reader& in) {
+        (detail::read_state(static_cast<Arg&>(*this), in), ...);
+    }
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        (detail::hash_layout(static_cast<Arg const&>(*this), h), ...);
+    }
+    void validate(detail::validator& v) const {
+        (detail::validate(static_cast<Arg const&>(*this), v), ...);
+    }
+
     constexpr char const** parse(char const** begin, char const** end) {
         bool has_args = true;
         while (begin != end && has_args) {
@@ -733,9 +2026,58 @@ struct group : Arg... {
         }
         return begin;
     }
+    constexpr char const**
+    parse(char const** begin, char const** end, diagnostic& diag) {
+        bool has_args = true;
+        while (begin != end && has_args) {
+            auto old = begin;
+            has_args =
+                ((begin = detail::parse_with<Arg>(*this, begin, end, diag),
+                  begin != old)
+                 || ...);
+        }
+        if (begin != end) {
+            diag.record(error_kind::unrecognized_argument, begin, 0, "group");
+        }
+        return begin;
+    }
+    // Parses with an instrumentation probe, which is passed on to every child
+    template <class Probe>
+    constexpr char const** parse(
+        char const** begin, char const** end, diagnostic& diag, Probe probe) {
+        bool has_args = true;
+        while (begin != end && has_args) {
+            has_args = parse_(begin, end, diag, probe, indicies);
+        }
+        if (begin != end) {
+            diag.record(error_kind::unrecognized_argument, begin, 0, "group");
+        }
+        return begin;
+    }
     constexpr intptr_t parse(int argc, char const** argv) {
         return parse(argv, argv + argc) - argv;
     }
+
+   private:
+    constexpr static auto indicies = std::index_sequence_for<Arg...>();
+    template <class Probe, size_t... I>
+    constexpr bool parse_(
+        char const**& begin,
+        char const** end,
+        diagnostic& diag,
+        Probe probe,
+        std::index_sequence<I...>) {
+        auto old = begin;
+        return (
+            (begin = detail::parse_with<Arg>(
+                 *this,
+                 begin,
+                 end,
+                 diag,
+                 probe.template child<detail::child_offset<I, Arg...>>()),
+             begin != old)
+            || ...);
+    }
 };
 template <class... Arg>
 group(Arg...) -> group<Arg...>;
@@ -746,7 +2088,31 @@ namespace arglet {
 template <class... Flag>
 struct flag_group : Flag... {
     using Flag::operator[]...;
+
+    constexpr void write_usage(detail::text_writer& out) const {
+        (detail::write_usage(static_cast<Flag const&>(*this), out), ...);
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        (detail::write_help(static_cast<Flag const&>(*this), out), ...);
+    }
+    void write_state(detail::snapshot_writer& out) const {
+        (detail::write_state(static_cast<Flag const&>(*this), out), ...);
+    }
+    constexpr void write_json(detail::json_writer& out) const {
+        (detail::write_json(static_cast<Flag const&>(*this), out), ...);
+    }
+    void read_state(detail::snapshot_reader& in) {
+        (detail::read_state(static_cast<Flag&>(*this), in), ...);
+    }
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        (detail::hash_layout(static_cast<Flag const&>(*this), h), ...);
+    }
     constexpr const char** parse(const char** begin, const char** end) {
+        diagnostic diag {.argv = begin};
+        return parse(begin, end, diag);
+    }
+    constexpr const char**
+    parse(const char** begin, const char** end, diagnostic& diag) {
         while (begin != end) {
             char const* this_arg = *begin;
             if (this_arg[0] == '-') {
@@ -757,6 +2123,13 @@ struct flag_group : Flag... {
                     if (!(Flag::parse_char(c) || ...)) {
                         successful = false;
                         reset_state(Flag::value...);
+                        if (this_arg[1] != '-') {
+                            diag.record(
+                                error_kind::unrecognized_flag,
+                                begin,
+                                i - 1,
+                                "flag_group");
+                        }
                         break;
                     }
                 }
@@ -781,16 +2154,349 @@ template <class... Flag>
 flag_group(Flag...) -> flag_group<Flag...>;
 } // namespace arglet
 
+// arglet::flag_bit implementation
+// arglet::packed_flags implementation
+namespace arglet {
+// Refers to the bit which holds one flag of a packed_flags
+class flag_bit {
+    std::uint64_t* word;
+    std::uint64_t mask;
+
+   public:
+    constexpr flag_bit(std::uint64_t& bits, std::uint64_t mask) noexcept
+      : word(&bits)
+      , mask(mask) {}
+    constexpr flag_bit(flag_bit const&) noexcept = default;
+
+    constexpr operator bool() const noexcept { return (*word & mask) != 0; }
+    constexpr flag_bit& operator=(bool value) noexcept {
+        *word = value ? *word | mask : *word & ~mask;
+        return *this;
+    }
+    constexpr flag_bit& operator=(flag_bit const& other) noexcept {
+        return *this = bool(other);
+    }
+};
+
+// Parses the same arguments as a flag_group of flags, but keeps every flag in
+// a single word rather than in a bool per flag:
+//
+//     packed_flags {flag {tags::all, 'a'}, flag {tags::list, 'l', "--list"}}
+//
+// parser[tag] returns a flag_bit. Saving and restoring the flags, and checking
+// whether any of them are set, each take a single operation on the word.
+template <class... Flag>
+struct packed_flags {
+    static_assert(
+        sizeof...(Flag) <= 64, "packed_flags holds at most 64 flags");
+
+    using state_type = std::uint64_t;
+
+    util::type_array<decltype(Flag::matcher)...> matchers;
+    // Bit I is set if the Ith flag was given
+    std::uint64_t bits = 0;
+
+    constexpr packed_flags(Flag... flags)
+      : matchers {flags.matcher...} {}
+
+    // Returns the bit used for the flag with the given tag, or 0 if there's no
+    // such flag
+    template <class Tag>
+    constexpr static std::uint64_t mask_for() noexcept {
+        std::uint64_t mask = 0;
+        std::uint64_t bit = 1;
+        ((mask |= std::is_same_v<Tag, decltype(Flag::tag)> ? bit : 0,
+          bit <<= 1),
+         ...);
+        return mask;
+    }
+
+    template <class Tag>
+        requires(mask_for<Tag>() != 0)
+    constexpr flag_bit operator[](Tag) noexcept {
+        return flag_bit(bits, mask_for<Tag>());
+    }
+    template <class Tag>
+        requires(mask_for<Tag>() != 0)
+    constexpr bool operator[](Tag) const noexcept {
+        return (bits & mask_for<Tag>()) != 0;
+    }
+
+    // True if any of the given flags are set. With no tags, true if any flag
+    // is set
+    template <class... Tag>
+    constexpr bool any(Tag...) const noexcept {
+        return (bits & mask_of<Tag...>()) != 0;
+    }
+    // True if every one of the given flags is set
+    template <class... Tag>
+    constexpr bool all(Tag...) const noexcept {
+        return (bits & mask_of<Tag...>()) == mask_of<Tag...>();
+    }
+    // Number of flags which are set
+    constexpr int count() const noexcept { return std::popcount(bits); }
+
+    constexpr std::uint64_t save() const noexcept { return bits; }
+    constexpr void restore(std::uint64_t saved) noexcept { bits = saved; }
+
+    constexpr const char** parse(const char** begin, const char** end) {
+        diagnostic diag {.argv = begin};
+        return parse(begin, end, diag);
+    }
+    constexpr const char**
+    parse(const char** begin, const char** end, diagnostic& diag) {
+        while (begin != end) {
+            char const* this_arg = *begin;
+            if (this_arg[0] == '-') {
+                // Flags are set in a copy of the word, so that nothing is
+                // kept if the argument contains an unrecognized flag
+                std::uint64_t new_bits = bits;
+                bool successful = true;
+                int i = 1;
+                while (char c = this_arg[i++]) {
+                    if (!parse_char(c, new_bits, indicies)) {
+                        successful = false;
+                        if (this_arg[1] != '-') {
+                            diag.record(
+                                error_kind::unrecognized_flag,
+                                begin,
+                                i - 1,
+                                "packed_flags");
+                        }
+                        break;
+                    }
+                }
+                if (successful) {
+                    bits = new_bits;
+                    begin++;
+                    continue;
+                }
+            }
+            if (parse_long_form(this_arg, indicies)) {
+                begin++;
+                continue;
+            }
+            return begin;
+        }
+        return begin;
+    }
+    constexpr intptr_t parse(int argc, char const** argv) {
+        return parse(argv, argv + argc) - argv;
+    }
+
+    constexpr void write_usage(detail::text_writer& out) const {
+        write_usage_(out, indicies);
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        write_help_(out, indicies);
+    }
+    void write_state(detail::snapshot_writer& out) const { out.write(bits); }
+    void read_state(detail::snapshot_reader& in) { in.read(bits); }
+    // Bit I belongs to the Ith flag, so the order of the flags matters
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (detail::hash_matcher(matchers[index<I>()], h), ...);
+        }(indicies);
+    }
+    constexpr void write_json(detail::json_writer& out) const {
+        write_json_(out, indicies);
+    }
+
+   private:
+    constexpr static auto indicies = std::index_sequence_for<Flag...>();
+
+    template <class... Tag>
+    constexpr static std::uint64_t mask_of() noexcept {
+        if constexpr (sizeof...(Tag) == 0) {
+            return ~std::uint64_t(0);
+        } else {
+            return (mask_for<Tag>() | ...);
+        }
+    }
+    template <size_t... I>
+    constexpr bool parse_char(
+        char c, std::uint64_t& word, std::index_sequence<I...>) const {
+        return (
+            matchers[index<I>()].parse_char(c, word, word | 1ull << I) || ...);
+    }
+    template <size_t... I>
+    constexpr bool
+    parse_long_form(char const* arg, std::index_sequence<I...>) {
+        return (
+            matchers[index<I>()].parse_long_form(arg, bits, bits | 1ull << I)
+            || ...);
+    }
+    template <size_t... I>
+    constexpr void
+    write_usage_(detail::text_writer& out, std::index_sequence<I...>) const {
+        ((out.put(" ["),
+          matchers[index<I>()].write_forms(out, "|"),
+          out.put(']')),
+         ...);
+    }
+    template <size_t... I>
+    constexpr void
+    write_help_(detail::text_writer& out, std::index_sequence<I...>) const {
+        ((out.put("  "),
+          matchers[index<I>()].write_forms(out, ", "),
+          out.put('\n')),
+         ...);
+    }
+    template <size_t... I>
+    constexpr void
+    write_json_(detail::json_writer& out, std::index_sequence<I...>) const {
+        (out.member(
+             detail::json_name<decltype(Flag::tag)>(
+                 matchers[index<I>()].name()),
+             (bits >> I & 1) != 0),
+         ...);
+    }
+};
+} // namespace arglet
+
 // arglet::option_set implementation
 namespace arglet {
+namespace detail {
+constexpr uint32_t name_hash_basis = 2166136261u;
+constexpr uint32_t name_hash_prime = 16777619u;
+
+// FNV-1a hash of a name
+constexpr uint32_t name_hash(std::string_view name) noexcept {
+    uint32_t hash = name_hash_basis;
+    for (char c : name) {
+        hash = (hash ^ uint8_t(c)) * name_hash_prime;
+    }
+    return hash;
+}
+
+// An open-addressed hash table of names, which finds the index of a name.
+// It's built by the constructor, so it's built at compile time when the
+// parser is constexpr or constinit. Used by option_set and multicall
+template <size_t N>
+struct hashed_names {
+    static_assert(N < 0xffff, "hashed_names holds fewer than 65535 names");
+
+    // At most half the slots are used, so probe sequences stay short
+    constexpr static size_t table_size = std::bit_ceil(2 * N);
+
+    std::array<std::string_view, N> names {};
+    // Index of the name in each slot plus one, or 0 if the slot is empty
+    std::array<uint16_t, table_size> slots {};
+
+    constexpr hashed_names() = default;
+    constexpr explicit hashed_names(
+        std::array<std::string_view, N> const& names)
+      : names(names) {
+        for (size_t i = 0; i < N; i++) {
+            size_t slot = find_slot(names[i], name_hash(names[i]));
+            // The first of two identical names is the one that's found
+            if (slots[slot] == 0) {
+                slots[slot] = uint16_t(i + 1);
+            }
+        }
+    }
+
+    // Returns the index of the name, or N if there is none. The hash is
+    // passed in so that callers can compute it while scanning the name
+    constexpr size_t find(std::string_view name, uint32_t hash) const noexcept {
+        size_t slot = find_slot(name, hash);
+        return slots[slot] == 0 ? N : size_t(slots[slot] - 1);
+    }
+    constexpr size_t find(std::string_view name) const noexcept {
+        return find(name, name_hash(name));
+    }
+
+   private:
+    // Returns the slot holding the name, or the empty slot where it would go
+    constexpr size_t
+    find_slot(std::string_view name, uint32_t hash) const noexcept {
+        size_t slot = hash & (table_size - 1);
+        while (slots[slot] != 0 && names[slots[slot] - 1] != name) {
+            slot = (slot + 1) & (table_size - 1);
+        }
+        return slot;
+    }
+};
+
+// Finds the option in an option_set whose long forms all share a key, such as
+// "--color=always", "--color=never", and "--color=auto". The key is compared
+// once, and the rest of the token is looked up in a hashed_names table of the
+// values, so the cost of a match depends on the length of the token and not
+// on the number of options.
+template <size_t N>
+struct keyed_options {
+    // The key, up to and including the '=', or empty if the options don't
+    // share a key
+    std::string_view key;
+    hashed_names<N> values;
+
+    constexpr keyed_options() = default;
+    constexpr explicit keyed_options(
+        std::array<std::string_view, N> const& forms) {
+        size_t eq = forms[0].find('=');
+        if (eq == std::string_view::npos) {
+            return;
+        }
+        std::string_view shared = forms[0].substr(0, eq + 1);
+        std::array<std::string_view, N> rest;
+        for (size_t i = 0; i < N; i++) {
+            if (!forms[i].starts_with(shared)) {
+                return;
+            }
+            rest[i] = forms[i].substr(shared.size());
+        }
+        key = shared;
+        values = hashed_names<N>(rest);
+    }
+
+    constexpr explicit operator bool() const noexcept { return !key.empty(); }
+
+    // Returns the index of the option matching arg, or N if there is none.
+    // The key is matched and the value is hashed in a single pass over arg
+    constexpr size_t find(char const* arg) const noexcept {
+        for (char c : key) {
+            if (*arg++ != c) {
+                return N;
+            }
+        }
+        char const* start = arg;
+        uint32_t hash = name_hash_basis;
+        for (; *arg; arg++) {
+            hash = (hash ^ uint8_t(*arg)) * name_hash_prime;
+        }
+        return values.find(std::string_view(start, arg), hash);
+    }
+};
+
+// Stands in for keyed_options when some option has a short form
+struct no_keyed_options {};
+} // namespace detail
+
+// Sets the value to that of whichever option matches the token. When every
+// option is a long flag, and they all share a key ("--color=always",
+// "--color=never", ...), the constructor builds a table of the values, and a
+// token is split once and looked up in the table. Otherwise each option is
+// tried in turn.
 template <class Tag, class T, bool is_optional, flag_form... forms>
 struct option_set {
    private:
-    constexpr static auto indicies =
-        std::make_index_sequence<sizeof...(forms)>();
+    constexpr static size_t N = sizeof...(forms);
+    constexpr static bool all_long = ((forms == flag_form::Long) && ...);
+    constexpr static auto indicies = std::make_index_sequence<N>();
+
+    template <size_t... I>
+    constexpr bool assign_(size_t index, std::index_sequence<I...>) {
+        return ((I == index && (value = options[tag_v<I>].option_value, true))
+                || ...);
+    }
     template <size_t... I>
     constexpr char const**
     parse_(const char** begin, const char**, std::index_sequence<I...>) {
+        if constexpr (all_long) {
+            if (keyed) {
+                return begin + assign_(keyed.find(begin[0]), indicies);
+            }
+        }
         std::string_view arg = begin[0];
         return begin + (options[tag_v<I>].match_assign(arg, value) || ...);
     }
@@ -801,17 +2507,60 @@ struct option_set {
     template <size_t... I>
     constexpr bool
     parse_long_form_(char const* arg, std::index_sequence<I...>) {
+        if constexpr (all_long) {
+            if (keyed) {
+                return assign_(keyed.find(arg), indicies);
+            }
+        }
         return (options[tag_v<I>].match_assign_long_form(arg, value) || ...);
     }
+    // Returns the index of the option whose value is held, or N if the value
+    // isn't that of any option
+    template <size_t... I>
+    constexpr size_t chosen_(std::index_sequence<I...>) const {
+        size_t chosen = N;
+        if constexpr (requires(T const& a, state_t const& b) { a == b; }) {
+            (void)((options[tag_v<I>].option_value == value
+                    && (chosen = I, true))
+                   || ...);
+        }
+        return chosen;
+    }
+    // Writes the name of the chosen option, or null
+    template <size_t... I>
+    constexpr void write_json_(
+        detail::json_writer& out,
+        size_t chosen,
+        std::index_sequence<I...>) const {
+        bool found =
+            ((I == chosen
+              && (out.put_string(options[tag_v<I>].matcher.name()), true))
+             || ...);
+        found ? void() : out.text.put("null");
+    }
 
    public:
     using state_t = std::conditional_t<is_optional, std::optional<T>, T>;
     [[no_unique_address]] Tag tag;
     state_t value {};
     util::type_array<option<T, forms>...> options;
+    [[no_unique_address]] std::conditional_t<
+        all_long,
+        detail::keyed_options<N>,
+        detail::no_keyed_options> keyed;
+
+    constexpr option_set(
+        Tag tag, state_t value, option<T, forms> const&... opts)
+      : tag(tag)
+      , value(std::move(value))
+      , options {opts...} {
+        if constexpr (all_long) {
+            keyed = detail::keyed_options<N>({opts.matcher.long_form...});
+        }
+    }
 
-    auto& operator[](Tag) { return value; }
-    auto const& operator[](Tag) const { return value; }
+    constexpr auto& operator[](Tag) { return value; }
+    constexpr auto const& operator[](Tag) const { return value; }
 
     constexpr char const**
     parse(char const** begin, [[maybe_unused]] char const** end) {
@@ -824,6 +2573,34 @@ struct option_set {
     constexpr bool parse_long_form(const char* arg) {
         return parse_long_form_(arg, indicies);
     }
+    constexpr void write_usage(detail::text_writer& out) const {
+        out.put(" [");
+        detail::write_option_usage(options, out, indicies);
+        out.put(']');
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        detail::write_option_help(options, out, indicies);
+    }
+    void write_state(detail::snapshot_writer& out) const { out.write(value); }
+    void read_state(detail::snapshot_reader& in) { in.read(value); }
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        detail::hash_options(options, h, indicies);
+    }
+    // The member is named by the tag, since the options have several flags.
+    // When the options share a key, the chosen option is written by its
+    // value ({"color":"auto"}), and otherwise by its name ({"level":"best"})
+    constexpr void write_json(detail::json_writer& out) const {
+        out.key(detail::json_name<Tag>());
+        size_t chosen = chosen_(indicies);
+        if constexpr (all_long) {
+            if (keyed) {
+                chosen < N ? out.put_string(keyed.values.names[chosen])
+                           : out.text.put("null");
+                return;
+            }
+        }
+        write_json_(out, chosen, indicies);
+    }
 };
 template <class Tag, class T, flag_form... forms>
 option_set(Tag, T, option<T, forms>...) -> option_set<Tag, T, false, forms...>;
@@ -868,12 +2645,75 @@ struct command_set {
         return parse(argv, argv + argc) - argv;
     }
 
-    auto& operator[](Tag) { return *this; }
-    auto const& operator[](Tag) const { return *this; }
+    constexpr auto& operator[](Tag) { return *this; }
+    constexpr auto const& operator[](Tag) const { return *this; }
     constexpr void set_default_command(command_fn func) noexcept {
         value = func;
     }
     constexpr command_fn get_default_command() const noexcept { return value; }
+    // Returns the long form of every command, in sorted order. Commands with
+    // only a short form are left out
+    constexpr auto command_names() const {
+        constexpr size_t count = ((forms != flag_form::Short) + ... + 0);
+        std::array<std::string_view, count> names {};
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            size_t i = 0;
+            (void(
+                 (forms != flag_form::Short)
+                 && (names[i++] = options[tag_v<I>].matcher.long_form, true)),
+             ...);
+        }(indicies);
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+    constexpr void write_usage(detail::text_writer& out) const {
+        out.put(" <");
+        detail::write_option_usage(options, out, indicies);
+        out.put('>');
+    }
+    constexpr void write_help(detail::text_writer& out) const {
+        detail::write_option_help(options, out, indicies);
+    }
+    // Function pointers differ between processes, so the index of the chosen
+    // command is written instead. If the command isn't one of the options, it
+    // was set with set_default_command, and the reader's default is kept
+    void write_state(detail::snapshot_writer& out) const {
+        uint32_t chosen = uint32_t(-1);
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (void)((options[tag_v<I>].option_value == value
+                    && (chosen = uint32_t(I), true))
+                   || ...);
+        }(indicies);
+        out.write(chosen);
+        out.write(command_name);
+    }
+    void read_state(detail::snapshot_reader& in) {
+        uint32_t chosen = uint32_t(-1);
+        in.read(chosen);
+        in.read(command_name);
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (void)((chosen == I
+                    && (value = options[tag_v<I>].option_value, true))
+                   || ...);
+        }(indicies);
+    }
+    // The index of the chosen command is saved, so the order of the commands
+    // is part of the layout
+    constexpr void hash_layout(detail::layout_hasher& h) const {
+        detail::hash_options(options, h, indicies);
+    }
+    // The chosen command is written by name, or as null if the command isn't
+    // one of the options
+    constexpr void write_json(detail::json_writer& out) const {
+        out.key(detail::json_name<Tag>());
+        bool found = [&]<size_t... I>(std::index_sequence<I...>) {
+            return ((options[tag_v<I>].option_value == value
+                     && (out.put_string(options[tag_v<I>].matcher.name()),
+                         true))
+                    || ...);
+        }(indicies);
+        found ? void() : out.text.put("null");
+    }
     constexpr operator bool() const { return value != nullptr; }
     constexpr operator command_fn() const { return value; }
     int operator()(int argc, char const** argv) const {
@@ -900,7 +2740,111 @@ command_set(Tag, std::nullptr_t, option<command_fn, forms>...)
     -> command_set<Tag, forms...>;
 } // namespace arglet
 
-// arglet::list_remaining implementation
+// arglet::multicall implementation
+namespace arglet {
+namespace detail {
+constexpr bool is_path_separator(char c) noexcept {
+#ifdef _WIN32
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
+}
+
+// Finds the basename of a path and hashes it in a single pass. The hash is
+// restarted after every path separator
+constexpr std::pair<std::string_view, uint32_t>
+hash_basename(char const* path) noexcept {
+    char const* start = path;
+    uint32_t hash = name_hash_basis;
+    for (; *path; path++) {
+        if (is_path_separator(*path)) {
+            start = path + 1;
+            hash = name_hash_basis;
+        } else {
+            hash = (hash ^ uint8_t(*path)) * name_hash_prime;
+        }
+    }
+    return {std::string_view(start, size_t(path - start)), hash};
+}
+} // namespace detail
+
+// Chooses a command by the name the program was run as, for programs that
+// are installed under several names:
+//
+//     sequence {
+//         multicall {tags::command, nullptr, option {"ls", ls_main}, ...},
+//         ...}
+//
+// takes the place of ignore_arg, and matches the basename of argv[0] against
+// the commands. The names are kept in a detail::hashed_names table, so it's
+// built at compile time when the parser is constexpr or constinit. A lookup
+// hashes argv[0] once and compares a single name in the common case. As with
+// command_set, the chosen command is called with parser[tag](argc, argv).
+template <class Tag, size_t N>
+struct multicall {
+    [[no_unique_address]] Tag tag;
+    command_fn value {};
+    // The basename of argv[0]
+    std::string_view command_name;
+    detail::hashed_names<N> names;
+    std::array<command_fn, N> commands {};
+
+    constexpr multicall(
+        Tag tag,
+        command_fn default_command,
+        std::same_as<option<command_fn, flag_form::Long>> auto const&... opts)
+      : tag(tag)
+      , value(default_command)
+      , names(std::array<std::string_view, N> {opts.matcher.long_form...})
+      , commands {opts.option_value...} {}
+
+    constexpr char const** parse(char const** begin, char const** end) {
+        if (begin == end) {
+            return begin;
+        }
+        auto [name, hash] = detail::hash_basename(begin[0]);
+        command_name = name;
+        size_t index = names.find(name, hash);
+        if (index < N) {
+            value = commands[index];
+        }
+        return begin + 1;
+    }
+    constexpr intptr_t parse(int argc, char const** argv) {
+        return parse(argv, argv + argc) - argv;
+    }
+
+    constexpr auto& operator[](Tag) { return *this; }
+    constexpr auto const& operator[](Tag) const { return *this; }
+    constexpr operator bool() const { return value != nullptr; }
+    constexpr operator command_fn() const { return value; }
+    // The name the program was run as, or null before parsing
+    constexpr void write_json(detail::json_writer& out) const {
+        out.key(detail::json_name<Tag>());
+        command_name.data() ? out.put_string(command_name)
+                            : out.text.put("null");
+    }
+    int operator()(int argc, char const** argv) const {
+        if (value) {
+            return value(argc, argv);
+        }
+        printf(
+            "'%.*s' is not one of the commands provided by this program.\n",
+            (int)command_name.size(),
+            command_name.data());
+        return 1;
+    }
+};
+template <class Tag, class... Option>
+multicall(Tag, command_fn, Option const&...)
+    -> multicall<Tag, sizeof...(Option)>;
+template <class Tag, class... Option>
+multicall(Tag, std::nullptr_t, Option const&...)
+    -> multicall<Tag, sizeof...(Option)>;
+} // namespace arglet
+
+// arglet::list implementation
 namespace arglet {
 template <class Tag, class Parser>
 struct list : group<item<Tag, Parser>> {
@@ -923,6 +2867,476 @@ list(Tag, std::vector<Elem>, Func)
     -> list<Tag, value_parser<Elem, Func, false>>;
 } // namespace arglet
 
+// arglet::traits::owns_no_heap_memory implementation
+// arglet::traits::is_allocation_free implementation
+namespace arglet::traits {
+// True if the state of the parser can't own memory on the heap, since a type
+// that does can't be trivially destructible. Flags, and values held as
+// integers, enums, or string_views, own none; parsers holding a container,
+// such as list, item, and multi_value_flag, do. Functions given to value
+// parsers aren't inspected, so one that allocates a temporary while parsing
+// isn't detected. Specialize this for a parser that owns no heap memory but
+// isn't trivially destructible
+template <class Parser>
+struct owns_no_heap_memory
+  : std::bool_constant<std::is_trivially_destructible_v<Parser>> {};
+
+template <class Parser>
+constexpr bool owns_no_heap_memory_v = owns_no_heap_memory<Parser>::value;
+
+// The same trait, under the name it was first asked for. It's just as
+// conservative: it says the parser's state owns no heap memory, not that
+// parsing can never allocate
+template <class Parser>
+using is_allocation_free = owns_no_heap_memory<Parser>;
+template <class Parser>
+constexpr bool is_allocation_free_v = owns_no_heap_memory_v<Parser>;
+} // namespace arglet::traits
+
+// arglet::parse_profile implementation
+namespace arglet {
+namespace detail {
+template <class Parser>
+constexpr std::string_view parser_name = "parser";
+template <class Tag, flag_form form>
+constexpr std::string_view parser_name<flag<Tag, form>> = "flag";
+template <>
+constexpr std::string_view parser_name<ignore_arg_t> = "ignore_arg";
+template <class Tag, class Parser>
+constexpr std::string_view parser_name<value<Tag, Parser>> = "value";
+template <class Tag, flag_form form, class Parser>
+constexpr std::string_view parser_name<value_flag<Tag, form, Parser>> =
+    "value_flag";
+template <class Tag, flag_form form, class Parser>
+constexpr std::string_view parser_name<multi_value_flag<Tag, form, Parser>> =
+    "multi_value_flag";
+template <class Tag, flag_form form, class Parser>
+constexpr std::string_view parser_name<prefixed_value<Tag, form, Parser>> =
+    "prefixed_value";
+template <class Tag, class Parser>
+constexpr std::string_view parser_name<item<Tag, Parser>> = "item";
+template <class Tag>
+constexpr std::string_view parser_name<string<Tag>> = "string";
+template <class... Flag>
+constexpr std::string_view parser_name<flag_group<Flag...>> = "flag_group";
+template <class... Flag>
+constexpr std::string_view parser_name<packed_flags<Flag...>> =
+    "packed_flags";
+template <class Tag, class T, bool is_optional, flag_form... forms>
+constexpr std::string_view
+    parser_name<option_set<Tag, T, is_optional, forms...>> = "option_set";
+template <class Tag, flag_form... forms>
+constexpr std::string_view parser_name<command_set<Tag, forms...>> =
+    "command_set";
+template <class Tag, size_t N>
+constexpr std::string_view parser_name<multicall<Tag, N>> = "multicall";
+template <class... Arg>
+constexpr std::string_view parser_name<sequence<Arg...>> = "sequence";
+template <class... Arg>
+constexpr std::string_view parser_name<group<Arg...>> = "group";
+template <class Tag, class Parser>
+constexpr std::string_view parser_name<list<Tag, Parser>> = "list";
+
+// Leaf parsers are a single node. Flags inside a flag_group are matched
+// character by character rather than offered tokens, so a flag_group is also a
+// single node
+template <class Parser>
+struct node_info {
+    constexpr static size_t count = 1;
+    constexpr static void describe(profile_row* rows, size_t depth) noexcept {
+        rows[0].parser = parser_name<Parser>;
+        rows[0].depth = depth;
+    }
+};
+
+template <class Parser, class... Arg>
+struct composite_node_info {
+    constexpr static size_t count = (node_info<Arg>::count + ... + 1);
+    constexpr static void describe(profile_row* rows, size_t depth) noexcept {
+        rows[0].parser = parser_name<Parser>;
+        rows[0].depth = depth;
+        size_t offset = 1;
+        ((node_info<Arg>::describe(rows + offset, depth + 1),
+          offset += node_info<Arg>::count),
+         ...);
+    }
+};
+
+template <class... Arg>
+struct node_info<sequence<Arg...>>
+  : composite_node_info<sequence<Arg...>, Arg...> {};
+template <class... Arg>
+struct node_info<group<Arg...>> : composite_node_info<group<Arg...>, Arg...> {};
+template <class Tag, class Parser>
+struct node_info<list<Tag, Parser>>
+  : composite_node_info<list<Tag, Parser>, item<Tag, Parser>> {};
+} // namespace detail
+
+// Instrumentation policy which counts, for every node in the parser tree, how
+// many tokens it was offered, how many it consumed, and the time spent in it.
+// Counters accumulate across parses until reset:
+//
+//     auto profile = make_profile(parser);
+//     parse(parser, argc, argv, diag, profile);
+//     profile.print();
+template <class Parser>
+struct parse_profile {
+    constexpr static size_t size = detail::node_info<Parser>::count;
+    // Counters for each node, in depth-first order. The root comes first
+    std::array<parser_counters, size> counters {};
+
+    constexpr detail::counting_probe probe() noexcept {
+        return {counters.data()};
+    }
+    constexpr void reset() noexcept { counters = {}; }
+
+    // Returns the counters as a flat table, one row per node in depth-first
+    // order
+    constexpr std::array<profile_row, size> table() const noexcept {
+        std::array<profile_row, size> rows {};
+        detail::node_info<Parser>::describe(rows.data(), 0);
+        for (size_t i = 0; i < size; i++) {
+            rows[i].counters = counters[i];
+        }
+        return rows;
+    }
+
+    // Prints the table, with each parser indented by its depth
+    void print(FILE* file = stderr) const noexcept {
+        fprintf(
+            file,
+            "%-24s %12s %12s %16s\n",
+            "parser",
+            "offered",
+            "consumed",
+            "cycles");
+        for (auto& row : table()) {
+            fprintf(
+                file,
+                "%*s%-*.*s %12llu %12llu %16llu\n",
+                int(row.depth * 2),
+                "",
+                int(24 - row.depth * 2),
+                int(row.parser.size()),
+                row.parser.data(),
+                (unsigned long long)row.counters.offered,
+                (unsigned long long)row.counters.consumed,
+                (unsigned long long)row.counters.cycles);
+        }
+    }
+};
+
+template <class Parser>
+constexpr parse_profile<Parser> make_profile(Parser const&) noexcept {
+    return {};
+}
+} // namespace arglet
+
+// arglet::snapshot implementation
+namespace arglet {
+namespace detail {
+// Hashes the name of a type, as spelled by the compiler. Programs built from
+// different parser trees get different hashes
+template <class T>
+constexpr uint64_t type_hash() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    std::string_view name = __FUNCSIG__;
+#else
+    std::string_view name = __PRETTY_FUNCTION__;
+#endif
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325;
+    for (char c : name) {
+        hash = (hash ^ uint8_t(c)) * 0x100000001b3;
+    }
+    return hash;
+}
+} // namespace detail
+
+// Identifies the layout of a snapshot of the given parser: the type of the
+// parser tree, and the flags and options of its parsers, in order. Snapshots
+// store fields in native byte order, so the byte order and the size of a
+// pointer are part of the schema
+template <class Parser>
+constexpr uint64_t snapshot_schema(Parser const& parser) noexcept {
+    detail::layout_hasher h {.hash = detail::type_hash<Parser>()};
+    detail::hash_layout(parser, h);
+    return h.hash ^ uint64_t(std::endian::native)
+           ^ (uint64_t(sizeof(void*)) << 56);
+}
+
+// A snapshot starts with this header, which is followed by the state of the
+// parser tree and then by the string pool. Nothing in a snapshot is a
+// pointer, so a snapshot can be copied or mapped anywhere in memory
+struct snapshot_header {
+    constexpr static uint32_t expected_magic = 0x53677261; // "argS"
+    constexpr static uint32_t current_version = 1;
+
+    uint32_t magic = expected_magic;
+    uint32_t version = current_version;
+    uint64_t schema = 0;
+    uint64_t data_size = 0;
+    uint64_t pool_size = 0;
+};
+
+// Returns the size in bytes of a snapshot of the parser's current state
+template <class Parser>
+size_t snapshot_size(Parser const& parser) noexcept {
+    detail::snapshot_writer measure;
+    detail::write_state(parser, measure);
+    return sizeof(snapshot_header) + measure.data_size + measure.pool_size;
+}
+
+// Writes a snapshot of the parser's current state into the buffer, and
+// returns its size. If the buffer is too small, nothing is written, and the
+// required size is returned; check the result against the size of the buffer
+template <class Parser>
+size_t save_snapshot(Parser const& parser, void* buffer, size_t size) noexcept {
+    detail::snapshot_writer measure;
+    detail::write_state(parser, measure);
+    snapshot_header header {
+        .schema = snapshot_schema(parser),
+        .data_size = measure.data_size,
+        .pool_size = measure.pool_size};
+    size_t total = sizeof(header) + header.data_size + header.pool_size;
+    if (total > size) {
+        return total;
+    }
+    auto* bytes = static_cast<unsigned char*>(buffer);
+    std::memcpy(bytes, &header, sizeof(header));
+    detail::snapshot_writer out {
+        .data = bytes + sizeof(header),
+        .pool = reinterpret_cast<char*>(bytes + sizeof(header)
+                                        + header.data_size)};
+    detail::write_state(parser, out);
+    return total;
+}
+
+// Restores the parser's state from a snapshot, and returns true on success.
+// The snapshot is rejected if it's truncated or malformed, or if it was made
+// by a program with a different parser tree; the parser is left unchanged.
+//
+// Strings are loaded as views into the snapshot, so that a snapshot in
+// shared memory is loaded without copying. The snapshot must outlive the
+// parser's string views.
+template <class Parser>
+bool load_snapshot(Parser& parser, void const* buffer, size_t size) {
+    snapshot_header header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    auto* bytes = static_cast<unsigned char const*>(buffer);
+    std::memcpy(&header, bytes, sizeof(header));
+    size_t available = size - sizeof(header);
+    if (header.magic != snapshot_header::expected_magic
+        || header.version != snapshot_header::current_version
+        || header.schema != snapshot_schema(parser)
+        || header.data_size > available
+        || header.pool_size > available - header.data_size) {
+        return false;
+    }
+    detail::snapshot_reader in {
+        .data = bytes + sizeof(header),
+        .data_size = header.data_size,
+        .pool = reinterpret_cast<char const*>(
+            bytes + sizeof(header) + header.data_size),
+        .pool_size = header.pool_size};
+    Parser loaded = parser;
+    detail::read_state(loaded, in);
+    if (!in.good || in.position != in.data_size) {
+        return false;
+    }
+    parser = std::move(loaded);
+    return true;
+}
+} // namespace arglet
+
+// arglet::write_json implementation
+namespace arglet {
+// Writes the parser's current state into the buffer as a JSON object, with a
+// member for each value, and returns the size of the JSON. Members are named
+// by the long form of the flag (or the short form, if there's no long form),
+// or by the name given by the tag:
+//
+//     struct files_t {
+//         constexpr static std::string_view name = "files";
+//     };
+//
+// Positional values, option sets and commands aren't named by a single flag,
+// so their tags must give a name.
+//
+// Nothing is allocated. If the buffer is too small, only the start of the JSON
+// is written, and the size it needs is returned; check the result against the
+// size of the buffer. The buffer isn't null terminated
+//
+// JSON can be written in a constant expression, unless the parser holds a
+// floating-point value, since std::to_chars isn't constexpr for those
+template <class Parser>
+constexpr size_t
+write_json(Parser const& parser, char* buffer, size_t size) {
+    detail::json_writer out {.text = {buffer, 0, size}};
+    out.text.put('{');
+    detail::write_json(parser, out);
+    out.text.put('}');
+    return out.text.size;
+}
+
+// Returns the size of the JSON written by write_json
+template <class Parser>
+constexpr size_t json_size(Parser const& parser) {
+    return write_json(parser, nullptr, 0);
+}
+} // namespace arglet
+
+// arglet::parse_result implementation
+// arglet::parse implementation
+namespace arglet {
+template <class Parser, size_t N>
+struct parse_result : Parser {
+    using Parser::operator[];
+    std::array<char const*, N> args;
+    intptr_t num_parsed = 0;
+    diagnostic diag;
+    constexpr bool all_parsed() const noexcept { return num_parsed == N; }
+};
+
+// Parses argv with the given parser, and returns the number of arguments that
+// were parsed. If not every argument was parsed, diag describes why parsing
+// stopped; otherwise diag is empty
+//
+// The instrumentation policy is either no_instrumentation, or a parse_profile
+// which records counters for every node in the parser tree
+template <class Parser, class Instrumentation = no_instrumentation>
+constexpr intptr_t parse(
+    Parser& parser,
+    int argc,
+    char const** argv,
+    diagnostic& diag,
+    Instrumentation&& instrumentation = {}) {
+    diag = diagnostic {.argv = argv};
+    char const** end = argv + (argc > 0 ? argc : 0);
+    char const** stop =
+        detail::parse_with(parser, argv, end, diag, instrumentation.probe());
+    if (stop == end) {
+        diag = diagnostic {};
+        return stop - argv;
+    }
+    if (!diag || diag.arg_index < stop - argv) {
+        diag = diagnostic {.argv = argv};
+        diag.record(error_kind::unrecognized_argument, stop, 0, "parser");
+    }
+    // argv isn't needed after parsing, and leaving it out means the diagnostic
+    // doesn't refer to argv when argv is temporary. The diagnostic is rebuilt
+    // rather than having argv reset, since GCC 12 otherwise rejects the result
+    // as a constant expression
+    diag = diagnostic {
+        diag.kind, diag.arg_index, diag.char_offset, diag.token, diag.parser};
+    return stop - argv;
+}
+
+// Parses argv as above, after checking that every argument is well-formed
+// UTF-8. With utf8::policy::reject, nothing is parsed if any argument is
+// invalid. With utf8::policy::report, every argument is parsed, and if parsing
+// succeeds diag still reports the first invalid argument. Either way, an
+// invalid argument is reported as invalid_utf8, at its first invalid byte
+template <class Parser>
+constexpr intptr_t parse(
+    Parser& parser,
+    int argc,
+    char const** argv,
+    diagnostic& diag,
+    utf8::policy action) {
+    int num_args = argc > 0 ? argc : 0;
+    intptr_t num_parsed = 0;
+    diag = diagnostic {};
+    for (int i = 0; i < num_args; i++) {
+        std::string_view arg = argv[i];
+        size_t offset = utf8::find_invalid(arg);
+        if (offset == arg.size()) {
+            continue;
+        }
+        if (action == utf8::policy::report) {
+            num_parsed = parse(parser, argc, argv, diag);
+        }
+        if (!diag) {
+            diag = diagnostic {
+                error_kind::invalid_utf8, i, offset, arg, "utf8"};
+        }
+        return num_parsed;
+    }
+    return parse(parser, argc, argv, diag);
+}
+
+// Parses a list of arguments with the given parser. The program name is not
+// prepended. Every built-in parser may be used in constant evaluation, so when
+// the arguments are string literals the result may be declared constexpr:
+//
+//     constexpr auto result = parse(parser, {"-v", "--threads=8"});
+template <class Parser, size_t N>
+constexpr auto parse(Parser parser, char const* const (&args)[N])
+    -> parse_result<Parser, N> {
+    std::array<char const*, N> arg_array {};
+    for (size_t i = 0; i < N; i++) {
+        arg_array[i] = args[i];
+    }
+    diagnostic diag;
+    intptr_t num_parsed = parse(parser, N, arg_array.data(), diag);
+    return {std::move(parser), arg_array, num_parsed, diag};
+}
+} // namespace arglet
+
+// arglet::help_text implementation
+namespace arglet {
+namespace detail {
+template <class Parser>
+constexpr void write_help_page(
+    Parser const& parser, std::string_view program, text_writer& out) {
+    out.put("Usage:");
+    if (!program.empty()) {
+        out.put(' ');
+        out.put(program);
+    }
+    write_usage(parser, out);
+    out.put('\n');
+
+    text_writer measure;
+    write_help(parser, measure);
+    if (measure.size > 0) {
+        out.put("\nOptions:\n");
+        write_help(parser, out);
+    }
+}
+
+template <auto GetParser, fixed_string Program>
+constexpr auto make_help_text() {
+    constexpr size_t size = [] {
+        text_writer out;
+        write_help_page(GetParser(), Program.view(), out);
+        return out.size;
+    }();
+    std::array<char, size + 1> text {};
+    text_writer out {text.data()};
+    write_help_page(GetParser(), Program.view(), out);
+    return text;
+}
+
+template <auto GetParser, fixed_string Program>
+constexpr auto help_text_storage = make_help_text<GetParser, Program>();
+} // namespace detail
+
+// Usage and help text for the parser returned by GetParser, which must be
+// callable in constant evaluation. The text is generated at compile time and
+// stored in a static, null-terminated buffer, so printing it is a single
+// write:
+//
+//     constexpr auto text = help_text<get_parser, "ls">;
+//     write(1, text.data(), text.size());
+template <auto GetParser, detail::fixed_string Program = "">
+constexpr std::string_view help_text {
+    detail::help_text_storage<GetParser, Program>.data(),
+    detail::help_text_storage<GetParser, Program>.size() - 1};
+} // namespace arglet
+
 namespace arglet::literals {
 template <char... D>
 constexpr size_t size_t_from_digits() {
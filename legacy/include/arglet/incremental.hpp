@@ -0,0 +1,250 @@
+#pragma once
+#include <algorithm>
+#include <arglet/arglet.hpp>
+#include <coroutine>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory_resource>
+#include <span>
+#include <utility>
+
+// Incremental parsing, for arguments which arrive one at a time. The parser is
+// driven by a coroutine, which suspends whenever it needs another token:
+//
+//     std::byte storage[1024];
+//     std::pmr::monotonic_buffer_resource frames(
+//         storage, sizeof(storage), std::pmr::null_memory_resource());
+//     char const* pending[16];
+//     arglet::diagnostic diag;
+//
+//     auto session =
+//         arglet::parse_incrementally(frames, parser, pending, diag);
+//     session.feed("-v");       // parser[tags::verbose] is now set
+//     session.feed("--name");   // waits for the value
+//     session.feed("worker");
+//     bool good = session.finish();
+//
+// The parser is applied repeatedly, like the body of a group, so it shouldn't
+// skip the program name. Tokens are not copied, and must outlive the parser.
+
+// arglet::incremental_parse implementation
+namespace arglet {
+class incremental_parse {
+   public:
+    struct promise_type;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    struct promise_type {
+        // The token being fed in, or null at the end of input
+        char const* token = nullptr;
+        // Number of tokens consumed by the parser so far
+        size_t num_parsed = 0;
+        bool good = true;
+
+        // The coroutine frame comes from the memory resource passed as the
+        // first argument. The resource is stored after the frame, so that the
+        // frame can be returned to it
+        constexpr static size_t footer_offset(size_t size) noexcept {
+            constexpr size_t align = alignof(std::pmr::memory_resource*);
+            return (size + align - 1) / align * align;
+        }
+        template <class... Args>
+        static void* operator new(
+            size_t size, std::pmr::memory_resource& frames, Args&...) {
+            size_t offset = footer_offset(size);
+            void* frame = frames.allocate(offset + sizeof(void*));
+            auto* footer = static_cast<std::byte*>(frame) + offset;
+            std::pmr::memory_resource* resource = &frames;
+            std::memcpy(footer, &resource, sizeof(resource));
+            return frame;
+        }
+        static void operator delete(void* frame, size_t size) noexcept {
+            size_t offset = footer_offset(size);
+            std::pmr::memory_resource* resource;
+            std::memcpy(
+                &resource,
+                static_cast<std::byte*>(frame) + offset,
+                sizeof(resource));
+            resource->deallocate(frame, offset + sizeof(void*));
+        }
+
+        incremental_parse get_return_object() noexcept {
+            return incremental_parse {handle_type::from_promise(*this)};
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(std::pair<bool, size_t> result) noexcept {
+            good = result.first;
+            num_parsed = result.second;
+        }
+        // Parsers report errors through the diagnostic, so an exception can
+        // only come from a converter. Without exceptions, this is never called
+        void unhandled_exception() {
+#ifdef __cpp_exceptions
+            throw;
+#else
+            std::terminate();
+#endif
+        }
+    };
+
+    incremental_parse(incremental_parse&& other) noexcept
+      : handle(std::exchange(other.handle, {})) {}
+    incremental_parse& operator=(incremental_parse other) noexcept {
+        std::swap(handle, other.handle);
+        return *this;
+    }
+    ~incremental_parse() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    // Gives the next token to the parser, which runs until it needs another
+    // one. Returns false if parsing has stopped because of an error
+    bool feed(char const* token) {
+        if (!handle || handle.done()) {
+            return false;
+        }
+        handle.promise().token = token;
+        handle.resume();
+        return !handle.done();
+    }
+    // Signals the end of input. Returns true if every token was parsed
+    bool finish() {
+        if (handle && !handle.done()) {
+            handle.promise().token = nullptr;
+            handle.resume();
+        }
+        return good();
+    }
+
+    // True once parsing has finished, either at the end of input or because
+    // of an error
+    bool stopped() const noexcept { return !handle || handle.done(); }
+    // False if parsing stopped because of an error, in which case the
+    // diagnostic describes it
+    bool good() const noexcept { return handle && handle.promise().good; }
+    // Number of tokens consumed so far
+    size_t num_parsed() const noexcept {
+        return handle ? handle.promise().num_parsed : 0;
+    }
+
+   private:
+    handle_type handle;
+    explicit incremental_parse(handle_type handle) noexcept
+      : handle(handle) {}
+};
+
+namespace detail {
+// Suspends the parser until the next token is fed in, and publishes the
+// number of tokens consumed so far
+struct next_token {
+    size_t num_parsed = 0;
+    incremental_parse::promise_type* promise = nullptr;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(incremental_parse::handle_type handle) noexcept {
+        promise = &handle.promise();
+        promise->num_parsed = num_parsed;
+    }
+    char const* await_resume() const noexcept { return promise->token; }
+};
+
+// Parses as many of the pending tokens as possible, and moves the remaining
+// ones to the front of the buffer. Returns false if the remaining tokens can't
+// be parsed. A flag that's missing its value is only an error at the end of
+// input: otherwise it waits for the next token.
+template <class Parser>
+bool parse_pending(
+    Parser& parser,
+    std::span<char const*> buffer,
+    size_t& num_pending,
+    size_t& num_parsed,
+    diagnostic& diag,
+    bool at_end) {
+    char const** begin = buffer.data();
+    char const** end = begin + num_pending;
+    diagnostic attempt {.argv = begin};
+    while (begin != end) {
+        char const** stop = parse_with(parser, begin, end, attempt);
+        if (stop == begin) {
+            break;
+        }
+        begin = stop;
+    }
+    size_t count = size_t(begin - buffer.data());
+    if (begin == end) {
+        num_parsed += count;
+        num_pending = 0;
+        return true;
+    }
+    if (!attempt || attempt.arg_index < intptr_t(count)) {
+        attempt = diagnostic {.argv = buffer.data()};
+        attempt.record(error_kind::unrecognized_argument, begin, 0, "parser");
+    }
+    bool waiting = !at_end && attempt.kind == error_kind::missing_value
+                   && attempt.arg_index == intptr_t(num_pending - 1);
+    if (!waiting) {
+        // Indices are reported relative to the first token fed in
+        diag = diagnostic {
+            attempt.kind,
+            attempt.arg_index + intptr_t(num_parsed),
+            attempt.char_offset,
+            attempt.token,
+            attempt.parser};
+    }
+    std::move(begin, end, buffer.data());
+    num_parsed += count;
+    num_pending -= count;
+    return waiting;
+}
+} // namespace detail
+
+// Starts parsing tokens as they're fed in. The coroutine frame is allocated
+// from frames. Tokens which the parser can't consume yet are kept in pending,
+// which bounds how far the parser can look ahead; two tokens is enough for
+// every built-in parser.
+//
+// A coroutine frame is always freed with the usual operator delete, even when
+// it came from a placement operator new, so GCC's -Wmismatched-new-delete is a
+// false positive here.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+template <class Parser>
+incremental_parse parse_incrementally(
+    // Only used by promise_type::operator new
+    [[maybe_unused]] std::pmr::memory_resource& frames,
+    Parser& parser,
+    std::span<char const*> pending,
+    diagnostic& diag) {
+    diag = diagnostic {};
+    size_t num_pending = 0;
+    size_t num_parsed = 0;
+    while (char const* token = co_await detail::next_token {num_parsed}) {
+        if (num_pending == pending.size()) {
+            diag = diagnostic {
+                error_kind::unrecognized_argument,
+                intptr_t(num_parsed + num_pending),
+                0,
+                token,
+                "parse_incrementally"};
+            co_return {false, num_parsed};
+        }
+        pending[num_pending++] = token;
+        if (!detail::parse_pending(
+                parser, pending, num_pending, num_parsed, diag, false)) {
+            co_return {false, num_parsed};
+        }
+    }
+    bool good = detail::parse_pending(
+        parser, pending, num_pending, num_parsed, diag, true);
+    co_return {good, num_parsed};
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+} // namespace arglet
@@ -0,0 +1,52 @@
+// Parsers declared at namespace scope must be constant-initialized, so that
+// they cost nothing at startup. Every parser here is declared constinit, and
+// the object file is checked for a .init_array section, which would hold any
+// dynamic initializer. Parsers which hold a std::vector (item, list, and
+// multi_value_flag) may be constinit as well, but their destructors are
+// registered at startup, so they're left out
+#include <arglet/arglet.hpp>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> all;
+constexpr tag<2> threads;
+constexpr tag<3> name;
+constexpr tag<4> mode;
+constexpr tag<5> color;
+constexpr tag<6> command;
+constexpr tag<7> list;
+} // namespace tags
+
+enum class mode { fast, safe };
+
+int run(int, char const**) { return 0; }
+
+using namespace arglet;
+
+constinit auto parser = sequence {
+    ignore_arg,
+    group {
+        flag_group {flag {tags::verbose, 'v', "--verbose"}},
+        packed_flags {flag {tags::all, 'a'}, flag {tags::list, "--list"}},
+        prefixed_value {tags::threads, 'j', "--threads=", 1},
+        value_flag {tags::name, "--name", std::string_view()},
+        option_set {
+            tags::mode,
+            mode::fast,
+            option {"--fast", mode::fast},
+            option {'s', "--safe", mode::safe}},
+        option_set {
+            tags::color,
+            std::optional<bool>(),
+            option {"--color", true},
+            option {"--no-color", false}}}};
+
+constinit auto commands =
+    command_set {tags::command, nullptr, option {"run", run}};
+
+constinit auto profile = make_profile(parser);
+
+intptr_t parse_args(int argc, char const** argv) {
+    return parser.parse(argc, argv) + commands.parse(argc, argv);
+}
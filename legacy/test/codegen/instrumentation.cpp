@@ -0,0 +1,54 @@
+// Compiled twice, with optimizations: once parsing through arglet::parse with
+// no_instrumentation, and once through a copy of the entry point as it was
+// before instrumentation was added, which calls the parsers directly. The two
+// object files must be identical, since disabled instrumentation may not
+// change the generated code
+#include <arglet/arglet.hpp>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> threads;
+constexpr tag<2> name;
+constexpr tag<3> files;
+} // namespace tags
+
+#ifdef ARGLET_REFERENCE_PARSE
+// arglet::parse, without an instrumentation policy
+template <class Parser>
+intptr_t reference_parse(
+    Parser& parser, int argc, char const** argv, arglet::diagnostic& diag) {
+    using namespace arglet;
+    diag = diagnostic {.argv = argv};
+    char const** end = argv + (argc > 0 ? argc : 0);
+    char const** stop = detail::parse_with(parser, argv, end, diag);
+    if (stop == end) {
+        diag = diagnostic {};
+        return stop - argv;
+    }
+    if (!diag || diag.arg_index < stop - argv) {
+        diag = diagnostic {.argv = argv};
+        diag.record(error_kind::unrecognized_argument, stop, 0, "parser");
+    }
+    diag = diagnostic {
+        diag.kind, diag.arg_index, diag.char_offset, diag.token, diag.parser};
+    return stop - argv;
+}
+#endif
+
+intptr_t parse_args(int argc, char const** argv, arglet::diagnostic& diag) {
+    using namespace arglet;
+
+    auto parser = sequence {
+        ignore_arg,
+        group {
+            flag_group {flag {tags::verbose, 'v'}},
+            prefixed_value {tags::threads, 'j', "--threads=", 1},
+            value_flag {tags::name, "--name", std::string_view()},
+            list {tags::files, std::vector<std::string_view>()}}};
+#ifdef ARGLET_REFERENCE_PARSE
+    return reference_parse(parser, argc, argv, diag);
+#else
+    return parse(parser, argc, argv, diag, no_instrumentation {});
+#endif
+}
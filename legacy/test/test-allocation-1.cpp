@@ -0,0 +1,209 @@
+#include <arglet/arglet.hpp>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+#include <vector>
+
+// Every allocation made through operator new, and (with glibc) through
+// malloc, is counted
+namespace counter {
+size_t news = 0;
+size_t mallocs = 0;
+
+size_t total() { return news + mallocs; }
+void reset() { news = mallocs = 0; }
+} // namespace counter
+
+#ifdef __GLIBC__
+// glibc only supports replacing malloc if calloc, realloc, and free are
+// replaced along with it, so all four forward to glibc's own allocator
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void __libc_free(void*);
+
+extern "C" void* malloc(size_t size) {
+    counter::mallocs++;
+    return __libc_malloc(size);
+}
+extern "C" void* calloc(size_t count, size_t size) {
+    counter::mallocs++;
+    return __libc_calloc(count, size);
+}
+extern "C" void* realloc(void* ptr, size_t size) {
+    counter::mallocs++;
+    return __libc_realloc(ptr, size);
+}
+extern "C" void free(void* ptr) { __libc_free(ptr); }
+
+// operator new calls the real malloc, so it's only counted once
+static void* allocate(size_t size) { return __libc_malloc(size ? size : 1); }
+static void deallocate(void* ptr) { __libc_free(ptr); }
+#else
+static void* allocate(size_t size) { return std::malloc(size ? size : 1); }
+static void deallocate(void* ptr) { std::free(ptr); }
+#endif
+
+static void* counted_new(size_t size) {
+    counter::news++;
+    if (void* ptr = allocate(size)) {
+        return ptr;
+    }
+#ifdef __cpp_exceptions
+    throw std::bad_alloc();
+#else
+    std::abort();
+#endif
+}
+void* operator new(size_t size) { return counted_new(size); }
+void* operator new[](size_t size) { return counted_new(size); }
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { deallocate(ptr); }
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> all;
+constexpr tag<2> list;
+constexpr tag<3> name;
+constexpr tag<4> threads;
+constexpr tag<5> color;
+constexpr tag<6> command;
+constexpr tag<7> input;
+constexpr tag<8> files;
+} // namespace tags
+
+enum class color { none, red, blue };
+
+int build(int, char const**) { return 1; }
+
+auto get_flag_parser() {
+    using namespace arglet;
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {flag {tags::verbose, 'v', "--verbose"}},
+            packed_flags {
+                flag {tags::all, 'a', "--all"},
+                flag {tags::list, 'l', "--list"}}}};
+}
+
+auto get_view_parser() {
+    using namespace arglet;
+    using std::string_view;
+    return sequence {
+        ignore_arg,
+        group {
+            value_flag {tags::name, "--name", string_view()},
+            prefixed_value {tags::threads, 'j', "--threads=", 1},
+            option_set {
+                tags::color,
+                color::none,
+                option {"--color=red", color::red},
+                option {"--color=blue", color::blue}}},
+        command_set {tags::command, nullptr, option {"build", build}},
+        string {tags::input}};
+}
+
+auto get_list_parser() {
+    using namespace arglet;
+    using std::string_view;
+    return sequence {
+        ignore_arg, list {tags::files, std::vector<string_view>()}};
+}
+
+auto get_item_parser() {
+    using namespace arglet;
+    using std::string_view;
+    return sequence {
+        ignore_arg, group {item {tags::files, std::vector<string_view>()}}};
+}
+
+auto get_multi_value_parser() {
+    using namespace arglet;
+    using std::string_view;
+    return sequence {
+        ignore_arg,
+        multi_value_flag {
+            tags::files, 'f', "--files", std::vector<string_view>()}};
+}
+
+// is_allocation_free is the same trait under the name it was asked for
+static_assert(arglet::traits::is_allocation_free_v<
+              decltype(get_flag_parser())>);
+static_assert(!arglet::traits::is_allocation_free<
+              decltype(get_list_parser())>::value);
+
+using arglet::traits::owns_no_heap_memory_v;
+static_assert(owns_no_heap_memory_v<decltype(get_flag_parser())>);
+static_assert(owns_no_heap_memory_v<decltype(get_view_parser())>);
+static_assert(!owns_no_heap_memory_v<decltype(get_list_parser())>);
+static_assert(!owns_no_heap_memory_v<decltype(get_item_parser())>);
+static_assert(!owns_no_heap_memory_v<decltype(get_multi_value_parser())>);
+static_assert(!owns_no_heap_memory_v<arglet::value_flag<
+                  arglet::tag<0>,
+                  arglet::flag_form::Long,
+                  arglet::value_parser<std::string>>>);
+
+// Returns the number of allocations made by a single parse of argv
+template <class Parser>
+size_t count_allocations(Parser& parser, std::vector<char const*>& argv) {
+    counter::reset();
+    intptr_t parsed = parser.parse(int(argv.size()), argv.data());
+    size_t count = counter::total();
+    return parsed == intptr_t(argv.size()) ? count : size_t(-1);
+}
+
+int main() {
+    bool good = true;
+
+    // The arguments are built before counting starts
+    std::vector<char const*> flag_args {
+        "prog", "-v", "--all", "-l", "--verbose"};
+    std::vector<char const*> view_args {
+        "prog", "--name", "worker", "-j8", "--color=blue", "build", "in.txt"};
+    std::vector<char const*> list_args {"prog"};
+    std::vector<char const*> item_args {"prog"};
+    std::vector<char const*> multi_args {"prog", "--files"};
+    constexpr size_t num_files = 64;
+    for (size_t i = 0; i < num_files; i++) {
+        list_args.push_back("file");
+        item_args.push_back("file");
+        multi_args.push_back("file");
+    }
+
+    auto flag_parser = get_flag_parser();
+    auto view_parser = get_view_parser();
+    size_t flag_count = count_allocations(flag_parser, flag_args);
+    size_t view_count = count_allocations(view_parser, view_args);
+    good = good && flag_count == 0 && view_count == 0;
+
+    // A list and an item append values one at a time, so the vector grows
+    // geometrically. multi_value_flag reserves space for all of its values at
+    // once
+    auto list_parser = get_list_parser();
+    auto item_parser = get_item_parser();
+    auto multi_parser = get_multi_value_parser();
+    size_t list_count = count_allocations(list_parser, list_args);
+    size_t item_count = count_allocations(item_parser, item_args);
+    size_t multi_count = count_allocations(multi_parser, multi_args);
+    size_t max_appends = 2 * size_t(std::bit_width(num_files));
+    good = good && list_count > 0 && list_count <= max_appends;
+    good = good && item_count > 0 && item_count <= max_appends;
+    good = good && multi_count == 1;
+
+    printf(
+        "Allocations per parse: flags %zu, views %zu, list %zu, item %zu, "
+        "multi_value_flag %zu\n",
+        flag_count,
+        view_count,
+        list_count,
+        item_count,
+        multi_count);
+
+    return !good;
+}
@@ -9,7 +9,7 @@ int hello(int, char const**);
 int goodbye(int, char const**);
 int print_name(int, char const**);
 
-auto get_parser() {
+constexpr auto get_parser() {
     using namespace arglet;
 
     return sequence {
@@ -22,6 +22,13 @@ auto get_parser() {
             option {'n', "name", print_name}}};
 }
 
+// Command names are listed in sorted order, for completion
+static_assert([] {
+    using namespace std::literals;
+    return get_parser()[tags::subcommand].command_names()
+           == std::array {"goodbye"sv, "hello"sv, "name"sv};
+}());
+
 int main(int argc, char const* argv[]) {
     bool good = true;
     using namespace arglet::test;
@@ -0,0 +1,83 @@
+#include <arglet/arglet.hpp>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> threads;
+constexpr tag<2> name;
+constexpr tag<3> color;
+constexpr tag<4> files;
+constexpr tag<5> count;
+} // namespace tags
+
+enum class color_mode { always, never, automatic };
+
+constexpr auto get_parser() {
+    using namespace arglet;
+
+    return group {
+        flag_group {
+            flag {tags::verbose, 'v', "--verbose"},
+            option_set {
+                tags::color,
+                color_mode::never,
+                option {"--color=always", color_mode::always},
+                option {"--color=auto", color_mode::automatic}}},
+        prefixed_value {tags::threads, 'j', "--threads=", 1},
+        value_flag {tags::name, 'n', "--name", std::string_view()},
+        value_flag {tags::count, "--count", std::uint64_t()}};
+}
+
+using arglet::parse;
+
+constexpr auto r1 = parse(get_parser(), {"-v", "--threads=8"});
+static_assert(r1.all_parsed());
+static_assert(r1[tags::verbose]);
+static_assert(r1[tags::threads] == 8);
+static_assert(r1[tags::color] == color_mode::never);
+
+constexpr auto r2 = parse(
+    get_parser(),
+    {"-j", "16", "--name", "arglet", "--color=auto", "--count", "42"});
+static_assert(r2.all_parsed());
+static_assert(!r2[tags::verbose]);
+static_assert(r2[tags::threads] == 16);
+static_assert(r2[tags::name] == "arglet");
+static_assert(r2[tags::color] == color_mode::automatic);
+static_assert(r2[tags::count] == 42);
+
+// Malformed and out-of-range integers are rejected
+static_assert(parse(get_parser(), {"--threads=8x"}).num_parsed == 0);
+static_assert(parse(get_parser(), {"--threads="}).num_parsed == 0);
+static_assert(parse(get_parser(), {"--threads=-2147483648"}).all_parsed());
+static_assert(parse(get_parser(), {"--threads=2147483648"}).num_parsed == 0);
+static_assert(parse(get_parser(), {"--count", "-1"}).num_parsed == 0);
+static_assert(
+    parse(get_parser(), {"--count", "18446744073709551615"})[tags::count]
+    == 18446744073709551615ull);
+static_assert(
+    parse(get_parser(), {"--count", "18446744073709551616"}).num_parsed == 0);
+
+// Parsers which allocate can still be run during constant evaluation, as long
+// as the result doesn't escape it
+static_assert([] {
+    using namespace arglet;
+    auto result = parse(
+        sequence {
+            ignore_arg,
+            group {
+                flag {tags::verbose, "--verbose"},
+                item {tags::files, std::vector<std::string_view>()}}},
+        {"./test", "a.txt", "--verbose", "b.txt"});
+    auto& files = result[tags::files];
+    return result.all_parsed() && result[tags::verbose] && files.size() == 2
+           && files[0] == "a.txt" && files[1] == "b.txt";
+}());
+
+int main() {
+    // Everything is checked at compile time, but the results must also be
+    // usable at runtime
+    bool good = r1.all_parsed() && r1[tags::threads] == 8
+                && r2[tags::name] == "arglet";
+    return !good;
+}
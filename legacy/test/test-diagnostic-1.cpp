@@ -0,0 +1,143 @@
+#include <arglet/arglet.hpp>
+#include <type_traits>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> all;
+constexpr tag<2> threads;
+constexpr tag<3> name;
+constexpr tag<4> files;
+} // namespace tags
+
+constexpr auto get_parser() {
+    using namespace arglet;
+
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {flag {tags::verbose, 'v'}, flag {tags::all, 'a'}},
+            prefixed_value {tags::threads, 'j', "--threads=", 1},
+            value_flag {tags::name, "--name", std::string_view()}}};
+}
+
+using arglet::error_kind;
+using arglet::parse;
+
+// Successful parses have no diagnostic
+static_assert(!parse(get_parser(), {"prog", "-va", "--name", "x"}).diag);
+
+// Unrecognized flags in a group of short flags report the offset of the flag
+constexpr auto d1 = parse(get_parser(), {"prog", "-v", "-vxa"}).diag;
+static_assert(d1.kind == error_kind::unrecognized_flag);
+static_assert(d1.arg_index == 2);
+static_assert(d1.char_offset == 2);
+static_assert(d1.token == "-vxa");
+static_assert(d1.parser == "flag_group");
+
+// Values which can't be parsed are reported at the value, not the flag
+constexpr auto d2 = parse(get_parser(), {"prog", "-j", "many"}).diag;
+static_assert(d2.kind == error_kind::invalid_value);
+static_assert(d2.arg_index == 2);
+static_assert(d2.token == "many");
+static_assert(d2.parser == "prefixed_value");
+
+// Prefixed values report the offset of the value within the token
+constexpr auto d3 = parse(get_parser(), {"prog", "-v", "--threads=x"}).diag;
+static_assert(d3.kind == error_kind::invalid_value);
+static_assert(d3.arg_index == 2);
+static_assert(d3.char_offset == 10);
+
+constexpr auto d4 = parse(get_parser(), {"prog", "-a", "--name"}).diag;
+static_assert(d4.kind == error_kind::missing_value);
+static_assert(d4.arg_index == 2);
+static_assert(d4.token == "--name");
+static_assert(d4.parser == "value_flag");
+
+// A missing value is preferred over an unrecognized flag at the same position,
+// since "-j" is recognized by prefixed_value but not by flag_group
+constexpr auto d7 = parse(get_parser(), {"prog", "-v", "-j"}).diag;
+static_assert(d7.kind == error_kind::missing_value);
+static_assert(d7.arg_index == 2);
+static_assert(d7.parser == "prefixed_value");
+
+// Arguments which no parser accepts are reported by the enclosing group
+constexpr auto d5 = parse(get_parser(), {"prog", "-j4", "file.txt"}).diag;
+static_assert(d5.kind == error_kind::unrecognized_argument);
+static_assert(d5.arg_index == 2);
+static_assert(d5.token == "file.txt");
+static_assert(d5.parser == "group");
+
+// Errors from earlier attempts don't survive once the argument is consumed
+constexpr auto d6 = parse(get_parser(), {"prog", "-j4", "-v", "--other"}).diag;
+static_assert(d6.kind == error_kind::unrecognized_argument);
+static_assert(d6.arg_index == 3);
+
+// Diagnostics are small, trivially copyable values
+static_assert(std::is_trivially_copyable_v<arglet::diagnostic>);
+
+int main() {
+    using std::string_view;
+    bool good = true;
+
+    char buffer[128];
+    size_t size = d2.format(buffer, sizeof(buffer));
+    good = good
+           && string_view(buffer, size)
+                  == "argument 2, offset 0: invalid value 'many' (rejected by "
+                     "prefixed_value)";
+
+    // Messages which don't fit are truncated, but the full size is returned
+    char small[8];
+    good = good && d2.format(small, sizeof(small)) == size
+           && string_view(small, sizeof(small)) == "argument";
+
+    // Parsing argv in place
+    char const* argv[] {"prog", "-v", "--bogus", nullptr};
+    auto parser = get_parser();
+    arglet::diagnostic diag;
+    intptr_t num_parsed = parse(parser, 3, argv, diag);
+    good = good && num_parsed == 2 && diag.arg_index == 2
+           && diag.token == "--bogus" && diag.argv == nullptr;
+    diag.print();
+
+    // A default-constructed diagnostic may be passed straight to a parser, in
+    // which case indices are relative to the first token recorded
+    char const* rest[] {"--name"};
+    arglet::value_flag name {tags::name, "--name", string_view()};
+    arglet::diagnostic direct;
+    good = good && name.parse(rest, rest + 1, direct) == rest
+           && direct.kind == error_kind::missing_value
+           && direct.arg_index == 0 && direct.token == "--name";
+
+    // Arguments can be checked for well-formed UTF-8 before they're parsed.
+    // If they're rejected, nothing is parsed
+    char const* encoded[] {"prog", "-v", "--name", "caf\xc3", "-a"};
+    auto checked = get_parser();
+    num_parsed = parse(checked, 5, encoded, diag, arglet::utf8::policy::reject);
+    good = good && num_parsed == 0 && diag.kind == error_kind::invalid_utf8
+           && diag.arg_index == 3 && diag.char_offset == 3
+           && diag.token == "caf\xc3" && diag.parser == "utf8"
+           && !checked[tags::verbose];
+
+    // Reporting them parses every argument, and still records the first one
+    checked = get_parser();
+    num_parsed = parse(checked, 5, encoded, diag, arglet::utf8::policy::report);
+    good = good && num_parsed == 5 && diag.kind == error_kind::invalid_utf8
+           && diag.arg_index == 3 && checked[tags::all]
+           && checked[tags::name] == "caf\xc3";
+
+    // If they're reported, errors from parsing come first
+    checked = get_parser();
+    char const* bogus[] {"prog", "--bogus", "\xff"};
+    num_parsed = parse(checked, 3, bogus, diag, arglet::utf8::policy::report);
+    good = good && num_parsed == 1
+           && diag.kind == error_kind::unrecognized_argument;
+
+    // Well-formed arguments parse as usual
+    char const* plain[] {"prog", "--name", "caf\xc3\xa9"};
+    num_parsed = parse(checked, 3, plain, diag, arglet::utf8::policy::reject);
+    good = good && num_parsed == 3 && !diag;
+
+    return !good;
+}
@@ -0,0 +1,90 @@
+#include <arglet/arglet.hpp>
+#include <cstdio>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> color;
+constexpr tag<2> threads;
+constexpr tag<3> output;
+constexpr tag<4> files;
+constexpr tag<5> subcommand;
+} // namespace tags
+
+enum class color_mode { always, never, automatic };
+
+int build(int, char const**) { return 0; }
+int clean(int, char const**) { return 0; }
+
+constexpr auto get_parser() {
+    using namespace arglet;
+
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {
+                flag {tags::verbose, 'v', "--verbose"},
+                option_set {
+                    tags::color,
+                    color_mode::never,
+                    option {"--color=always", color_mode::always},
+                    option {"--color=auto", color_mode::automatic}}},
+            prefixed_value {tags::threads, 'j', "--threads=", 1},
+            value_flag {tags::output, 'o', std::string_view()},
+            item {tags::files, std::vector<std::string_view>()}}};
+}
+
+constexpr auto get_command_parser() {
+    using namespace arglet;
+
+    return sequence {
+        ignore_arg,
+        command_set {
+            tags::subcommand,
+            nullptr,
+            option {"build", build},
+            option {'c', "clean", clean}}};
+}
+
+constexpr auto get_positional_parser() {
+    using namespace arglet;
+
+    return sequence {ignore_arg, value {tags::output, std::string_view()}};
+}
+
+constexpr std::string_view expected_help =
+    "Usage: tool [-v|--verbose] [--color=always|--color=auto] "
+    "[-j<value>|--threads=<value>] [-o <value>] [<value>...]\n"
+    "\n"
+    "Options:\n"
+    "  -v, --verbose\n"
+    "  --color=always\n"
+    "  --color=auto\n"
+    "  -j<value>, --threads=<value>\n"
+    "  -o <value>\n";
+
+constexpr std::string_view expected_command_help =
+    "Usage: <build|-c|clean>\n"
+    "\n"
+    "Options:\n"
+    "  build\n"
+    "  -c, clean\n";
+
+static_assert(arglet::help_text<get_parser, "tool"> == expected_help);
+static_assert(arglet::help_text<get_command_parser> == expected_command_help);
+// No options section is written if there are no options
+static_assert(
+    arglet::help_text<get_positional_parser, "cat">
+    == "Usage: cat <value>\n");
+// The text is null-terminated
+static_assert(
+    arglet::help_text<get_parser, "tool">.data()[expected_help.size()] == '\0');
+
+int main() {
+    constexpr auto text = arglet::help_text<get_parser, "tool">;
+    bool good = text == expected_help;
+    if (!good) {
+        fwrite(text.data(), 1, text.size(), stderr);
+    }
+    return !good;
+}
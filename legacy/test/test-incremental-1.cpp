@@ -0,0 +1,109 @@
+#include <arglet/incremental.hpp>
+#include <memory_resource>
+#include <string_view>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> threads;
+constexpr tag<2> name;
+} // namespace tags
+
+auto get_parser() {
+    using namespace arglet;
+
+    return group {
+        flag_group {flag {tags::verbose, 'v'}},
+        prefixed_value {tags::threads, 'j', "--threads=", 1},
+        value_flag {tags::name, "--name", std::string_view()}};
+}
+
+// Counts the allocations made from a buffer on the stack. Nothing is taken
+// from the heap: the upstream resource throws if the buffer runs out
+struct counting_resource : std::pmr::memory_resource {
+    std::pmr::monotonic_buffer_resource buffer;
+    int allocations = 0;
+    int deallocations = 0;
+
+    counting_resource(void* storage, size_t size)
+      : buffer(storage, size, std::pmr::null_memory_resource()) {}
+
+    void* do_allocate(size_t size, size_t align) override {
+        allocations++;
+        return buffer.allocate(size, align);
+    }
+    void do_deallocate(void* p, size_t size, size_t align) override {
+        deallocations++;
+        buffer.deallocate(p, size, align);
+    }
+    bool do_is_equal(memory_resource const& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+int main() {
+    bool good = true;
+    alignas(std::max_align_t) std::byte storage[2048];
+
+    {
+        counting_resource frames(storage, sizeof(storage));
+        auto parser = get_parser();
+        char const* pending[4];
+        arglet::diagnostic diag;
+        {
+            auto session =
+                arglet::parse_incrementally(frames, parser, pending, diag);
+            good = good && frames.allocations == 1;
+
+            // Results are visible as soon as a token is parsed
+            good = good && session.feed("-v") && parser[tags::verbose]
+                   && session.num_parsed() == 1;
+
+            // A flag waits for its value
+            good = good && session.feed("--name") && session.num_parsed() == 1;
+            good = good && session.feed("worker") && session.num_parsed() == 3
+                   && parser[tags::name] == "worker";
+            good = good && session.feed("-j") && session.feed("8")
+                   && parser[tags::threads] == 8;
+
+            good = good && session.finish() && session.stopped()
+                   && session.num_parsed() == 5 && !diag;
+        }
+        // The frame is returned when the session is destroyed
+        good = good && frames.deallocations == 1;
+    }
+
+    {
+        // Unrecognized tokens stop parsing immediately, and are reported at
+        // their position in the input
+        counting_resource frames(storage, sizeof(storage));
+        auto parser = get_parser();
+        char const* pending[4];
+        arglet::diagnostic diag;
+        auto session =
+            arglet::parse_incrementally(frames, parser, pending, diag);
+        good = good && session.feed("-v") && !session.feed("--bogus");
+        good = good && session.stopped() && !session.good()
+               && diag.kind == arglet::error_kind::unrecognized_argument
+               && diag.arg_index == 1 && diag.token == "--bogus";
+        good = good && !session.feed("-v");
+    }
+
+    {
+        // A flag still waiting for its value at the end of input is missing
+        // its value
+        counting_resource frames(storage, sizeof(storage));
+        auto parser = get_parser();
+        char const* pending[4];
+        arglet::diagnostic diag;
+        auto session =
+            arglet::parse_incrementally(frames, parser, pending, diag);
+        good = good && session.feed("-v") && session.feed("--name");
+        good = good && !session.finish()
+               && diag.kind == arglet::error_kind::missing_value
+               && diag.arg_index == 1 && diag.token == "--name";
+        diag.print();
+    }
+
+    return !good;
+}
@@ -0,0 +1,92 @@
+#include <arglet/arglet.hpp>
+#include <type_traits>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> all;
+constexpr tag<2> threads;
+constexpr tag<3> name;
+} // namespace tags
+
+constexpr auto get_parser() {
+    using namespace arglet;
+
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {flag {tags::verbose, 'v'}, flag {tags::all, 'a'}},
+            prefixed_value {tags::threads, 'j', "--threads=", 1},
+            value_flag {tags::name, "--name", std::string_view()}}};
+}
+
+using parser_t = decltype(get_parser());
+
+// The disabled policy carries no state
+static_assert(std::is_empty_v<arglet::no_instrumentation>);
+
+// The nodes of the tree are numbered in depth-first order
+constexpr auto rows = arglet::parse_profile<parser_t>().table();
+static_assert(rows.size() == 6);
+static_assert(rows[0].parser == "sequence" && rows[0].depth == 0);
+static_assert(rows[1].parser == "ignore_arg" && rows[1].depth == 1);
+static_assert(rows[2].parser == "group" && rows[2].depth == 1);
+static_assert(rows[3].parser == "flag_group" && rows[3].depth == 2);
+static_assert(rows[4].parser == "prefixed_value" && rows[4].depth == 2);
+static_assert(rows[5].parser == "value_flag" && rows[5].depth == 2);
+
+// Counting is usable in constant evaluation, where no cycles are counted
+constexpr auto count_tokens() {
+    auto parser = get_parser();
+    auto profile = arglet::make_profile(parser);
+    char const* argv[] {"prog", "--name", "x", "-va"};
+    arglet::diagnostic diag;
+    arglet::parse(parser, 4, argv, diag, profile);
+    return profile.table();
+}
+constexpr auto counted = count_tokens();
+static_assert(counted[0].counters.offered == 1);
+static_assert(counted[0].counters.consumed == 4);
+static_assert(counted[1].counters.consumed == 1);
+static_assert(counted[2].counters.consumed == 3);
+// The group offers "--name" to each parser in turn until one accepts it, and
+// then "-va", which the first parser accepts
+static_assert(counted[3].counters.offered == 2);
+static_assert(counted[3].counters.consumed == 1);
+static_assert(counted[4].counters.offered == 1);
+static_assert(counted[4].counters.consumed == 0);
+static_assert(counted[5].counters.offered == 1);
+static_assert(counted[5].counters.consumed == 2);
+static_assert(counted[0].counters.cycles == 0);
+
+int main() {
+    bool good = true;
+
+    char const* argv[] {"prog", "-j4", "--name", "x", "--bogus"};
+    auto parser = get_parser();
+    auto profile = arglet::make_profile(parser);
+    arglet::diagnostic diag;
+    intptr_t num_parsed = arglet::parse(parser, 5, argv, diag, profile);
+    good = good && num_parsed == 4 && diag.token == "--bogus";
+
+    // Results are the same as when parsing without instrumentation
+    auto plain = get_parser();
+    arglet::diagnostic plain_diag;
+    good = good && arglet::parse(plain, 5, argv, plain_diag) == num_parsed
+           && plain[tags::threads] == parser[tags::threads]
+           && plain[tags::name] == parser[tags::name];
+
+    // Counters accumulate across parses until they're reset
+    arglet::parse(parser, 5, argv, diag, profile);
+    auto table = profile.table();
+    good = good && table[0].counters.consumed == 8
+           && table[4].counters.consumed == 2;
+    // Cycles are inclusive, so the root accounts for its children
+    good = good && table[0].counters.cycles >= table[2].counters.cycles;
+    profile.print(stdout);
+
+    profile.reset();
+    good = good && profile.table()[0].counters.offered == 0;
+
+    return !good;
+}
@@ -0,0 +1,159 @@
+#include <arglet/arglet.hpp>
+#include <array>
+#include <charconv>
+#include <string_view>
+#include <vector>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> threads;
+constexpr tag<2> name;
+constexpr tag<6> all;
+constexpr tag<7> list;
+constexpr tag<8> ratio;
+
+// A tag may name its member. Parsers without a flag of their own, such as
+// option sets, commands, and positional values, need a named tag
+template <arglet::detail::fixed_string Name>
+struct named {
+    constexpr static std::string_view name = Name.view();
+};
+constexpr named<"color"> color;
+constexpr named<"command"> command;
+constexpr named<"level"> level;
+constexpr named<"files"> files;
+} // namespace tags
+
+enum class color { none, red, blue };
+
+double parse_ratio(std::string_view arg) {
+    double value = 0;
+    std::from_chars(arg.data(), arg.data() + arg.size(), value);
+    return value;
+}
+
+int build(int, char const**) { return 1; }
+int clean(int, char const**) { return 2; }
+
+constexpr auto get_flags() {
+    using namespace arglet;
+    using std::string_view;
+
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {flag {tags::verbose, 'v', "--verbose"}},
+            packed_flags {flag {tags::all, 'a'}, flag {tags::list, "--list"}},
+            prefixed_value {tags::threads, 'j', "--threads=", 1},
+            value_flag {tags::name, "--name", std::optional<string_view>()},
+            option_set {
+                tags::color,
+                color::none,
+                option {"--color=none", color::none},
+                option {"--color=red", color::red},
+                option {"--color=blue", color::blue}},
+            option_set {
+                tags::level,
+                0,
+                option {"--fast", 1},
+                option {"--best", 9}}}};
+}
+
+// The JSON is written during constant evaluation when the parse is constexpr
+template <size_t N>
+constexpr auto to_json(auto const& parser) {
+    std::array<char, N> buffer {};
+    size_t size = arglet::write_json(parser, buffer.data(), N);
+    return std::pair {buffer, size};
+}
+constexpr auto r1 =
+    arglet::parse(get_flags(), {"prog", "-v", "-a", "--best"});
+static_assert(r1.all_parsed());
+constexpr size_t r1_size = arglet::json_size(r1);
+constexpr auto r1_json = to_json<r1_size>(r1);
+static_assert(r1_json.second == r1_size);
+static_assert(
+    std::string_view(r1_json.first.data(), r1_size)
+    == R"({"verbose":true,"a":true,"list":false,"threads":1,"name":null,)"
+       R"("color":"none","level":"best"})");
+
+constexpr auto r2 = arglet::parse(
+    get_flags(), {"prog", "--name", "a \"b\"\n", "--color=blue", "-j8"});
+static_assert(r2.all_parsed());
+constexpr auto r2_json = to_json<arglet::json_size(r2)>(r2);
+static_assert(
+    std::string_view(r2_json.first.data(), r2_json.second)
+    == R"({"verbose":false,"a":false,"list":false,"threads":8,)"
+       R"("name":"a \"b\"\n","color":"blue","level":null})");
+
+// Well-formed UTF-8 is copied as is, and each byte which isn't part of it is
+// replaced, so the JSON is valid whatever the arguments were
+constexpr auto r3 =
+    arglet::parse(get_flags(), {"prog", "--name", "caf\xc3\xa9 \xff\xc3"});
+static_assert(r3.all_parsed());
+constexpr auto r3_json = to_json<arglet::json_size(r3)>(r3);
+static_assert(
+    std::string_view(r3_json.first.data(), r3_json.second)
+    == R"({"verbose":false,"a":false,"list":false,"threads":1,)"
+       "\"name\":\"caf\xc3\xa9 \\ufffd\\ufffd\","
+       R"("color":"none","level":null})");
+
+auto get_parser() {
+    using namespace arglet;
+    using std::string_view;
+
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {flag {tags::verbose, 'v'}},
+            value_flag {tags::ratio, "--ratio", parse_ratio}},
+        command_set {
+            tags::command,
+            nullptr,
+            option {"build", build},
+            option {"clean", clean}},
+        list {tags::files, std::vector<string_view>()}};
+}
+
+int main() {
+    bool good = true;
+    using std::string_view;
+
+    char const* argv[] {"prog", "--ratio", "0.25", "clean", "a", "b\x01"};
+    auto parser = get_parser();
+    good = good && parser.parse(6, argv) == 6;
+
+    constexpr string_view expected =
+        R"({"v":false,"ratio":0.25,"command":"clean","files":["a","b\u0001"]})";
+    char buffer[128];
+    size_t size = arglet::write_json(parser, buffer, sizeof(buffer));
+    good = good && string_view(buffer, size) == expected;
+    good = good && arglet::json_size(parser) == expected.size();
+
+    // Only the start is written into a buffer that's too small
+    char small[16] {};
+    good = good && arglet::write_json(parser, small, 10) == expected.size();
+    good = good && string_view(small) == expected.substr(0, 10);
+
+    // Long arguments are checked with the vectorized path
+    char const* encoded[] {
+        "prog", "build", "a long file name \xe2\x82\xac with \xed\xa0\x80"};
+    auto parsed = get_parser();
+    good = good && parsed.parse(3, encoded) == 3;
+    size = arglet::write_json(parsed, buffer, sizeof(buffer));
+    good = good
+           && string_view(buffer, size)
+                  == "{\"v\":false,\"ratio\":null,\"command\":\"build\","
+                     "\"files\":[\"a long file name \xe2\x82\xac with "
+                     "\\ufffd\\ufffd\\ufffd\"]}";
+
+    // Before parsing, there's no command
+    auto unparsed = get_parser();
+    size = arglet::write_json(unparsed, buffer, sizeof(buffer));
+    good = good
+           && string_view(buffer, size)
+                  == R"({"v":false,"ratio":null,"command":null,"files":[]})";
+
+    return !good;
+}
@@ -0,0 +1,116 @@
+#include <arglet/arglet.hpp>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> config;
+constexpr tag<1> threads;
+constexpr tag<2> sizes;
+constexpr tag<3> name;
+} // namespace tags
+
+int num_conversions = 0;
+
+struct config {
+    std::string_view path;
+};
+std::optional<config> load_config(std::string_view path) {
+    num_conversions++;
+    if (path.ends_with(".toml")) {
+        return config {path};
+    }
+    return std::nullopt;
+}
+
+auto get_parser() {
+    using namespace arglet;
+
+    return sequence {
+        ignore_arg,
+        group {
+            value_flag {tags::config, "--config", lazy(load_config)},
+            prefixed_value {tags::threads, 'j', "--threads=", lazy(1)},
+            value_flag {tags::name, "--name", std::string_view()},
+            item {tags::sizes, lazy(std::vector<int>())}}};
+}
+
+int main() {
+    bool good = true;
+
+    {
+        char const* argv[] {"prog", "--config", "a.toml", "-j", "8", "3", "4"};
+        auto parser = get_parser();
+        good = good && parser.parse(7, argv) == 7;
+
+        // Nothing is converted until it's accessed, and then only once
+        good = good && num_conversions == 0;
+        good = good && parser[tags::config]->path == "a.toml";
+        good = good && parser[tags::config]->path == "a.toml";
+        good = good && num_conversions == 1;
+        good = good && parser[tags::threads] == 8;
+        good = good && parser[tags::sizes] == std::vector {3, 4};
+
+        arglet::diagnostic diag;
+        good = good && arglet::validate_all(parser, 7, argv, diag) && !diag;
+        good = good && num_conversions == 1;
+    }
+
+    {
+        // Values that aren't accessed are never converted
+        char const* argv[] {"prog", "--config", "b.toml", "--name", "x"};
+        auto parser = get_parser();
+        good = good && parser.parse(5, argv) == 5
+               && parser[tags::name] == "x" && num_conversions == 1;
+    }
+
+    {
+        // Invalid tokens are accepted while parsing, and reported by
+        // validate_all at their position in argv
+        char const* argv[] {"prog", "3", "--threads=many", "x", "5"};
+        auto parser = get_parser();
+        good = good && parser.parse(5, argv) == 5;
+
+        arglet::diagnostic diag;
+        good = good && !arglet::validate_all(parser, 5, argv, diag);
+        good = good && diag.kind == arglet::error_kind::invalid_value
+               && diag.arg_index == 3 && diag.token == "x"
+               && diag.parser == "item";
+        diag.print();
+
+        // Invalid tokens leave the value unchanged
+        good = good && parser[tags::threads] == 1
+               && parser[tags::sizes] == std::vector {3, 5};
+    }
+
+    {
+        // An eager item stops at the first token it can't convert, but a lazy
+        // item accepts every token
+        using namespace arglet;
+        char const* argv[] {"3", "x", "5"};
+        auto eager = group {item {tags::sizes, std::vector<int>()}};
+        auto lazy_sizes = group {item {tags::sizes, lazy(std::vector<int>())}};
+        good = good && eager.parse(3, argv) == 1
+               && lazy_sizes.parse(3, argv) == 3;
+        good = good && lazy_sizes[tags::sizes] == std::vector {3, 5};
+
+        arglet::diagnostic diag;
+        good = good && !arglet::validate_all(lazy_sizes, 3, argv, diag)
+               && diag.arg_index == 1 && diag.token == "x"
+               && diag.parser == "item";
+    }
+
+    {
+        // The error is reported within the token
+        char const* argv[] {"prog", "--threads=many"};
+        auto parser = get_parser();
+        arglet::diagnostic diag;
+        good = good && parser.parse(2, argv) == 2
+               && !arglet::validate_all(parser, 2, argv, diag)
+               && diag.arg_index == 1 && diag.char_offset == 10
+               && diag.parser == "prefixed_value";
+    }
+
+    return !good;
+}
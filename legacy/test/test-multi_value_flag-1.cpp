@@ -0,0 +1,157 @@
+#include <arglet/arglet.hpp>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> include;
+constexpr tag<1> sizes;
+constexpr tag<2> verbose;
+constexpr tag<3> one;
+constexpr tag<4> ports;
+} // namespace tags
+
+auto get_parser() {
+    using namespace arglet;
+
+    return sequence {
+        ignore_arg,
+        group {
+            multi_value_flag {
+                tags::include,
+                'I',
+                "--include",
+                std::vector<std::string_view>()},
+            multi_value_flag {tags::sizes, "--sizes", std::vector<int>()},
+            flag {tags::verbose, 'v'}}};
+}
+
+using sv_list = std::vector<std::string_view>;
+
+// Values don't need to be default constructible
+struct port {
+    int number;
+    explicit port(int number) : number(number) {}
+};
+std::optional<port> parse_port(std::string_view arg) {
+    int number = 0;
+    for (char c : arg) {
+        if (c < '0' || c > '9') {
+            return std::nullopt;
+        }
+        number = number * 10 + (c - '0');
+    }
+    return port(number);
+}
+
+// A negative number is a value, but anything else starting with '-' is a flag
+static_assert(arglet::detail::is_flag_like("-v"));
+static_assert(arglet::detail::is_flag_like("--sizes"));
+static_assert(arglet::detail::is_flag_like("-1x"));
+static_assert(arglet::detail::is_flag_like("-."));
+static_assert(arglet::detail::is_flag_like("-e5"));
+static_assert(!arglet::detail::is_flag_like("-"));
+static_assert(!arglet::detail::is_flag_like("-12"));
+static_assert(!arglet::detail::is_flag_like("-2.5"));
+static_assert(!arglet::detail::is_flag_like("-.5"));
+static_assert(!arglet::detail::is_flag_like("-1e-3"));
+
+int main() {
+    bool good = true;
+
+    {
+        char const* argv[] {
+            "prog", "-I", "a", "b", "-", "-v", "--include", "c", "--sizes", "1",
+        };
+        auto parser = get_parser();
+        arglet::diagnostic diag;
+        good = good && arglet::parse(parser, 10, argv, diag) == 10 && !diag;
+        good = good && parser[tags::include] == sv_list {"a", "b", "-", "c"};
+        good = good && parser[tags::verbose];
+        good = good && parser[tags::sizes] == std::vector {1};
+    }
+
+    {
+        // Every value is consumed by a single call, with one allocation
+        char const* argv[] {"--sizes", "1", "2", "3", "4", "5", "-v"};
+        arglet::multi_value_flag flag {
+            tags::sizes, "--sizes", std::vector<int>()};
+        good = good && flag.parse(7, argv) == 6;
+        good = good && flag[tags::sizes] == std::vector {1, 2, 3, 4, 5};
+        good = good && flag[tags::sizes].capacity() >= 5;
+    }
+
+    {
+        // Negative numbers are values, not flags
+        char const* argv[] {"prog", "--sizes", "-1", "-2", "3", "-v"};
+        auto parser = get_parser();
+        arglet::diagnostic diag;
+        good = good && arglet::parse(parser, 6, argv, diag) == 6 && !diag;
+        good = good && parser[tags::sizes] == std::vector {-1, -2, 3};
+        good = good && parser[tags::verbose];
+    }
+
+    {
+        // A short flag named by a digit is a value when it follows the list,
+        // but is recognized before it
+        using namespace arglet;
+        auto get_digit_parser = [] {
+            return group {
+                multi_value_flag {tags::sizes, "--sizes", std::vector<int>()},
+                flag {tags::one, '1'}};
+        };
+        char const* after[] {"--sizes", "3", "-1"};
+        auto p1 = get_digit_parser();
+        good = good && p1.parse(3, after) == 3
+               && p1[tags::sizes] == std::vector {3, -1} && !p1[tags::one];
+
+        char const* before[] {"-1", "--sizes", "3"};
+        auto p2 = get_digit_parser();
+        good = good && p2.parse(3, before) == 3
+               && p2[tags::sizes] == std::vector {3} && p2[tags::one];
+    }
+
+    {
+        // The flag needs at least one value
+        char const* argv[] {"prog", "--sizes", "-v"};
+        auto parser = get_parser();
+        arglet::diagnostic diag;
+        good = good && arglet::parse(parser, 3, argv, diag) == 1;
+        good = good && diag.kind == arglet::error_kind::missing_value
+               && diag.arg_index == 1 && diag.parser == "multi_value_flag";
+        diag.print();
+    }
+
+    {
+        // Invalid values are reported where they occur, and none of the
+        // values are kept
+        char const* argv[] {"prog", "--sizes", "1", "x", "3"};
+        auto parser = get_parser();
+        arglet::diagnostic diag;
+        good = good && arglet::parse(parser, 5, argv, diag) == 1;
+        good = good && diag.kind == arglet::error_kind::invalid_value
+               && diag.arg_index == 3 && diag.token == "x";
+        good = good && parser[tags::sizes].empty();
+        diag.print();
+    }
+
+    {
+        // An invalid value rolls back the values given with the flag
+        char const* argv[] {"--ports", "80", "x"};
+        arglet::multi_value_flag flag {
+            tags::ports, "--ports", std::vector<port>(), parse_port};
+        good = good && flag.parse(3, argv) == 0 && flag[tags::ports].empty();
+    }
+
+    {
+        // Lazy values are kept as tokens until they're accessed
+        char const* argv[] {"--sizes", "7", "8"};
+        arglet::multi_value_flag flag {
+            tags::sizes, "--sizes", arglet::lazy(std::vector<int>())};
+        good = good && flag.parse(3, argv) == 3;
+        good = good && flag[tags::sizes] == std::vector {7, 8};
+    }
+
+    return !good;
+}
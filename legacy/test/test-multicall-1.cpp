@@ -0,0 +1,83 @@
+#include <arglet/arglet.hpp>
+#include <string>
+
+namespace tags {
+constexpr arglet::tag<0> command;
+constexpr arglet::tag<1> verbose;
+} // namespace tags
+
+int ls_main(int, char const**) { return 10; }
+int cat_main(int, char const**) { return 11; }
+int cp_main(int, char const**) { return 12; }
+int mv_main(int, char const**) { return 13; }
+
+constexpr auto get_parser() {
+    using namespace arglet;
+
+    return sequence {
+        multicall {
+            tags::command,
+            nullptr,
+            option {"ls", ls_main},
+            option {"cat", cat_main},
+            option {"cp", cp_main},
+            option {"mv", mv_main}},
+        group {flag {tags::verbose, 'v'}}};
+}
+
+// The table is built at compile time, and every command can be found in it
+constexpr auto parser = get_parser();
+static_assert(parser.names.table_size == 8);
+static_assert([] {
+    for (auto name : {"ls", "cat", "cp", "mv"}) {
+        auto p = get_parser();
+        char const* argv[] {name};
+        if (p.parse(1, argv) != 1 || !p[tags::command]) {
+            return false;
+        }
+    }
+    return true;
+}());
+
+// Only the basename of argv[0] is used
+constexpr auto r1 = arglet::parse(get_parser(), {"/usr/local/bin/cp", "-v"});
+static_assert(r1.all_parsed() && r1[tags::verbose]);
+static_assert(r1[tags::command].value == cp_main);
+static_assert(r1[tags::command].command_name == "cp");
+
+// Unknown names keep the default, which is null here
+constexpr auto r2 = arglet::parse(get_parser(), {"./rm"});
+static_assert(r2.all_parsed() && !r2[tags::command]);
+static_assert(r2[tags::command].command_name == "rm");
+
+int main() {
+    bool good = true;
+
+    char const* argv[] {"bin/mv", "-v"};
+    auto p = get_parser();
+    good = good && p.parse(2, argv) == 2;
+    good = good && p[tags::command](2, argv) == 13;
+
+    // Many names, as in a program installed under hundreds of names
+    std::string names[200];
+    for (int i = 0; i < 200; i++) {
+        names[i] = "command-" + std::to_string(i);
+    }
+    auto many = [&]<size_t... I>(std::index_sequence<I...>) {
+        return arglet::multicall {
+            tags::command,
+            ls_main,
+            arglet::option {std::string_view(names[I]), cp_main}...};
+    }(std::make_index_sequence<200>());
+    for (int i = 0; i < 200; i++) {
+        std::string path = "/bin/" + names[i];
+        char const* args[] {path.c_str()};
+        many.value = ls_main;
+        good = good && many.parse(1, args) == 1 && many.value == cp_main;
+    }
+    char const* unknown[] {"/bin/command-200"};
+    many.value = ls_main;
+    good = good && many.parse(1, unknown) == 1 && many.value == ls_main;
+
+    return !good;
+}
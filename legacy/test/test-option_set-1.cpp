@@ -0,0 +1,98 @@
+#include <arglet/arglet.hpp>
+#include <string>
+
+namespace tags {
+constexpr arglet::tag<0> color;
+constexpr arglet::tag<1> verbose;
+constexpr arglet::tag<2> level;
+} // namespace tags
+
+enum class color_mode { never, always, automatic };
+
+constexpr auto get_parser() {
+    using namespace arglet;
+
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {
+                flag {tags::verbose, 'v', "--verbose"},
+                option_set {
+                    tags::color,
+                    color_mode::never,
+                    option {"--color=always", color_mode::always},
+                    option {"--color=never", color_mode::never},
+                    option {"--color=auto", color_mode::automatic}}},
+            // These don't share a key, so each option is tried in turn
+            option_set {
+                tags::level,
+                0,
+                option {"--fast", 1},
+                option {"--best", 9},
+                option {"--level=1", 1}}}};
+}
+
+// The key is found, and the table is built, at compile time
+constexpr auto color_set = arglet::option_set {
+    tags::color,
+    color_mode::never,
+    arglet::option {"--color=always", color_mode::always},
+    arglet::option {"--color=auto", color_mode::automatic}};
+static_assert(bool(color_set.keyed));
+static_assert(color_set.keyed.key == "--color=");
+static_assert(color_set.keyed.find("--color=auto") == 1);
+static_assert(color_set.keyed.find("--color=au") == 2);
+static_assert(color_set.keyed.find("--colour=auto") == 2);
+
+// Without a shared key, there's no table
+constexpr auto unkeyed_set = arglet::option_set {
+    tags::color,
+    color_mode::never,
+    arglet::option {"--color=always", color_mode::always},
+    arglet::option {"--colour=auto", color_mode::automatic}};
+static_assert(!unkeyed_set.keyed);
+
+constexpr auto r1 = arglet::parse(get_parser(), {"prog", "--color=auto"});
+static_assert(r1.all_parsed() && r1[tags::color] == color_mode::automatic);
+
+constexpr auto r2 =
+    arglet::parse(get_parser(), {"prog", "--color=always", "--level=1"});
+static_assert(r2.all_parsed() && r2[tags::color] == color_mode::always);
+static_assert(r2[tags::level] == 1);
+
+// A value that isn't one of the options isn't consumed
+constexpr auto r3 = arglet::parse(get_parser(), {"prog", "--color=maybe"});
+static_assert(!r3.all_parsed() && r3[tags::color] == color_mode::never);
+
+int main() {
+    bool good = true;
+
+    char const* argv[] {"prog", "--color=auto", "--best", "-v"};
+    auto p = get_parser();
+    good = good && p.parse(4, argv) == 4;
+    good = good && p[tags::color] == color_mode::automatic;
+    good = good && p[tags::level] == 9 && p[tags::verbose];
+
+    // Many choices, each found by its value
+    std::string forms[100];
+    for (int i = 0; i < 100; i++) {
+        forms[i] = "--mode=choice-" + std::to_string(i);
+    }
+    auto many = [&]<size_t... I>(std::index_sequence<I...>) {
+        return arglet::option_set {
+            tags::level,
+            -1,
+            arglet::option {std::string_view(forms[I]), int(I)}...};
+    }(std::make_index_sequence<100>());
+    good = good && many.keyed.key == "--mode=";
+    for (int i = 0; i < 100; i++) {
+        char const* args[] {forms[i].c_str()};
+        good = good && many.parse(1, args) == 1 && many[tags::level] == i;
+    }
+    char const* unknown[] {"--mode=choice-100"};
+    good = good && many.parse(1, unknown) == 0;
+    char const* bare[] {"--mode"};
+    good = good && many.parse(1, bare) == 0;
+
+    return !good;
+}
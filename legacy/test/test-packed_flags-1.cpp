@@ -0,0 +1,69 @@
+#include <arglet/arglet.hpp>
+#include <cstdint>
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> all;
+constexpr tag<1> list;
+constexpr tag<2> human;
+constexpr tag<3> recursive;
+constexpr tag<4> name;
+} // namespace tags
+
+constexpr auto get_parser() {
+    using namespace arglet;
+
+    return sequence {
+        ignore_arg,
+        group {
+            packed_flags {
+                flag {tags::all, 'a'},
+                flag {tags::list, 'l', "--list"},
+                flag {tags::human, 'h', "--human-readable"},
+                flag {tags::recursive, "--recursive"}},
+            value_flag {tags::name, "--name", std::string_view()}}};
+}
+
+// Every flag is a single bit, so only the matchers are stored per flag
+constexpr auto flags = arglet::packed_flags {
+    arglet::flag {tags::all, 'a'},
+    arglet::flag {tags::list, 'l'},
+    arglet::flag {tags::human, 'h'}};
+static_assert(sizeof(flags.matchers) == 3);
+
+constexpr auto r1 = arglet::parse(get_parser(), {"prog", "-al", "--recursive"});
+static_assert(r1.all_parsed());
+static_assert(r1[tags::all] && r1[tags::list]);
+static_assert(!r1[tags::human] && r1[tags::recursive]);
+static_assert(r1.bits == 0b1011);
+
+// Flags from an argument with an unrecognized flag are all discarded
+constexpr auto r2 = arglet::parse(get_parser(), {"prog", "-l", "-ahx"});
+static_assert(r2.num_parsed == 2 && r2.bits == 0b0010);
+static_assert(r2.diag.kind == arglet::error_kind::unrecognized_flag);
+static_assert(r2.diag.arg_index == 2 && r2.diag.char_offset == 3);
+static_assert(r2.diag.parser == "packed_flags");
+
+int main() {
+    bool good = true;
+
+    char const* argv[] {"prog", "--human-readable", "--name", "x", "-a"};
+    auto parser = get_parser();
+    good = good && parser.parse(5, argv) == 5;
+    good = good && parser.any(tags::list, tags::human);
+    good = good && !parser.any(tags::list, tags::recursive);
+    good = good && parser.all(tags::human, tags::all);
+    good = good && !parser.all(tags::human, tags::list);
+    good = good && parser.any() && parser.count() == 2;
+
+    // parser[tag] refers to the flag's bit
+    auto saved = parser.save();
+    parser[tags::list] = true;
+    parser[tags::human] = false;
+    parser[tags::recursive] = parser[tags::all];
+    good = good && parser.bits == 0b1011;
+    parser.restore(saved);
+    good = good && parser.bits == 0b0101;
+
+    return !good;
+}
@@ -0,0 +1,173 @@
+#include <arglet/arglet.hpp>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace tags {
+using arglet::tag;
+constexpr tag<0> verbose;
+constexpr tag<1> threads;
+constexpr tag<2> name;
+constexpr tag<3> color;
+constexpr tag<4> command;
+constexpr tag<5> files;
+} // namespace tags
+
+enum class color { none, red, blue };
+
+int build(int, char const**) { return 1; }
+int clean(int, char const**) { return 2; }
+
+auto get_parser() {
+    using namespace arglet;
+    using std::string_view;
+
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {flag {tags::verbose, 'v'}},
+            prefixed_value {tags::threads, 'j', "--threads=", 1},
+            value_flag {tags::name, "--name", std::optional<string_view>()},
+            option_set {
+                tags::color,
+                color::none,
+                option {"--red", color::red},
+                option {"--blue", color::blue}}},
+        command_set {
+            tags::command,
+            nullptr,
+            option {"build", build},
+            option {"clean", clean}},
+        list {tags::files, std::vector<string_view>()}};
+}
+
+// The same parser tree, with the commands in a different order
+auto get_reordered_parser() {
+    using namespace arglet;
+    using std::string_view;
+
+    return sequence {
+        ignore_arg,
+        group {
+            flag_group {flag {tags::verbose, 'v'}},
+            prefixed_value {tags::threads, 'j', "--threads=", 1},
+            value_flag {tags::name, "--name", std::optional<string_view>()},
+            option_set {
+                tags::color,
+                color::none,
+                option {"--red", color::red},
+                option {"--blue", color::blue}}},
+        command_set {
+            tags::command,
+            nullptr,
+            option {"clean", clean},
+            option {"build", build}},
+        list {tags::files, std::vector<string_view>()}};
+}
+static_assert(
+    std::is_same_v<decltype(get_parser()), decltype(get_reordered_parser())>);
+
+auto get_other_parser() {
+    using namespace arglet;
+    return sequence {ignore_arg, flag {tags::verbose, 'v'}};
+}
+
+template <class Parser>
+bool same_state(Parser const& a, Parser const& b) {
+    return a[tags::verbose] == b[tags::verbose]
+           && a[tags::threads] == b[tags::threads]
+           && a[tags::name] == b[tags::name]
+           && a[tags::color] == b[tags::color]
+           && a[tags::command].value == b[tags::command].value
+           && a[tags::command].command_name == b[tags::command].command_name
+           && a[tags::files] == b[tags::files];
+}
+
+int main() {
+    bool good = true;
+
+    // Arguments live in a temporary buffer, so that loaded strings can only
+    // point into the snapshot
+    std::string storage[] {
+        "prog", "-v", "-j8", "--name", "worker", "--blue", "clean", "a", "b"};
+    std::vector<char const*> argv;
+    for (auto& arg : storage) {
+        argv.push_back(arg.c_str());
+    }
+    auto parser = get_parser();
+    good = good && parser.parse(int(argv.size()), argv.data()) == 9;
+
+    // A buffer that's too small isn't written to, and the size is returned
+    size_t size = arglet::snapshot_size(parser);
+    char small[8] {};
+    good = good && arglet::save_snapshot(parser, small, sizeof(small)) == size;
+
+    std::vector<char> snapshot(size);
+    good = good
+           && arglet::save_snapshot(parser, snapshot.data(), size) == size;
+    for (auto& arg : storage) {
+        std::fill(arg.begin(), arg.end(), '?');
+    }
+
+    auto loaded = get_parser();
+    good = good && arglet::load_snapshot(loaded, snapshot.data(), size);
+    good = good && loaded[tags::verbose] && loaded[tags::threads] == 8
+           && loaded[tags::name] == "worker"
+           && loaded[tags::color] == color::blue
+           && loaded[tags::command]({}, {}) == 2
+           && loaded[tags::command].command_name == "clean"
+           && loaded[tags::files] == std::vector<std::string_view> {"a", "b"};
+
+    // Strings are views into the snapshot
+    auto name = *loaded[tags::name];
+    good = good && name.data() >= snapshot.data()
+           && name.data() + name.size() <= snapshot.data() + size;
+
+    // Snapshots of a different parser tree are rejected
+    auto other = get_other_parser();
+    good = good && !arglet::load_snapshot(other, snapshot.data(), size);
+
+    // The chosen command is saved by index, so reordering the commands changes
+    // the schema even though the type is the same
+    auto reordered = get_reordered_parser();
+    good = good
+           && arglet::snapshot_schema(reordered)
+                  != arglet::snapshot_schema(get_parser())
+           && !arglet::load_snapshot(reordered, snapshot.data(), size);
+
+    // Truncated and corrupted snapshots are rejected, and leave the parser
+    // unchanged
+    auto fresh = get_parser();
+    good = good && !arglet::load_snapshot(fresh, snapshot.data(), size - 1);
+    std::vector<char> corrupted = snapshot;
+    // The first field is the verbose flag, and 7 is not a valid bool
+    corrupted[sizeof(arglet::snapshot_header)] = 7;
+    good = good
+           && !arglet::load_snapshot(fresh, corrupted.data(), corrupted.size())
+           && same_state(fresh, get_parser());
+
+#ifdef __linux__
+    // Workers map the snapshot from a memfd, and load it in place
+    int fd = memfd_create("arglet-snapshot", 0);
+    good = good && fd >= 0 && write(fd, snapshot.data(), size) == ssize_t(size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    good = good && mapped != MAP_FAILED;
+    if (mapped != MAP_FAILED) {
+        auto worker = get_parser();
+        good = good && arglet::load_snapshot(worker, mapped, size)
+               && same_state(worker, loaded);
+        auto worker_name = *worker[tags::name];
+        good = good && worker_name.data() >= static_cast<char*>(mapped)
+               && worker_name.data() < static_cast<char*>(mapped) + size;
+        munmap(mapped, size);
+    }
+    close(fd);
+#endif
+
+    return !good;
+}
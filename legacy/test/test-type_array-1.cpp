@@ -0,0 +1,36 @@
+#include <arglet/arglet.hpp>
+#include <type_traits>
+#include <utility>
+
+using arglet::tag_v;
+using arglet::util::type_array;
+
+// Elements are brace-initialized in order, and looked up by index
+constexpr type_array<int, char, std::string_view> arr {1, 'a', "hello"};
+static_assert(arr[tag_v<0>] == 1);
+static_assert(arr[tag_v<1>] == 'a');
+static_assert(arr[tag_v<2>] == "hello");
+
+// The element type is found through decl_elem
+static_assert(std::is_same_v<decltype(arr.decl_elem(tag_v<1>)), char>);
+
+// Empty elements take up no space
+struct empty {};
+static_assert(sizeof(type_array<empty, int>) == sizeof(int));
+
+// Storage is flat, so large arrays are cheap to instantiate
+template <size_t... I>
+constexpr auto make_large_array(std::index_sequence<I...>) {
+    return type_array<arglet::tag<I>...> {};
+}
+using large_array = decltype(make_large_array(std::make_index_sequence<512>()));
+static_assert(std::is_same_v<
+              decltype(large_array {}[tag_v<511>]),
+              arglet::tag<511>&&>);
+
+int main() {
+    type_array<int, double> values {1, 2.5};
+    values[tag_v<0>] += 1;
+    values[tag_v<1>] *= 2;
+    return !(values[tag_v<0>] == 2 && values[tag_v<1>] == 5.0);
+}
@@ -0,0 +1,26 @@
+// Flag maps and parsers declared at namespace scope must be
+// constant-initialized, so that they cost nothing at startup. Every object
+// here is declared constinit, and the object file is checked for a
+// .init_array section, which would hold any dynamic initializer
+#include <arglet/arg_view.hpp>
+#include <arglet/completion.hpp>
+#include <arglet/flags.hpp>
+#include <arglet/remaining.hpp>
+
+using namespace arglet::flags;
+
+constexpr auto flag_args = tuplet::tuple {
+    flag_spec<"-v, --version">,
+    flag_spec<"-h, -?, --help">,
+    flag_arg<0, 2> {{}, {"--color", "--colour"}}};
+
+constinit auto short_flags = make_short_flag_map(flag_args);
+constinit auto long_flags = make_long_flag_map(flag_args);
+constinit any_flag_arg version = tuplet::get<0>(flag_args);
+constinit arglet::arg_view no_args;
+constinit arglet::remaining rest;
+
+bool handle_completion(int argc, char const** argv) {
+    return arglet::completion::handle_request(
+        argc, argv, long_flags, short_flags);
+}
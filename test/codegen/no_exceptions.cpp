@@ -0,0 +1,55 @@
+// The headers must compile with -fno-exceptions and -fno-rtti. This file is
+// built with both, and uses every header, so that the templates in them are
+// instantiated
+#include <arglet/arg_view.hpp>
+#include <arglet/completion.hpp>
+#include <arglet/flags.hpp>
+#include <arglet/remaining.hpp>
+#include <arglet/schema.hpp>
+#include <arglet/utf8.hpp>
+
+#include <array>
+
+using namespace arglet::flags;
+
+constexpr auto flag_args = tuplet::tuple {
+    flag_spec<"-v, --version">,
+    flag_spec<"-h, --help">,
+    flag_spec<"--color">};
+constexpr auto long_flags = make_long_flag_map(flag_args);
+constexpr auto short_flags = make_short_flag_map(flag_args);
+
+int parse_with_maps(int argc, char const** argv) {
+    if (arglet::completion::handle_request(
+            argc, argv, long_flags, short_flags)) {
+        return 0;
+    }
+    arglet::arg_view args(argc, argv);
+    args.pop();
+    if (arglet::utf8::validate(args, arglet::utf8::policy::reject)) {
+        return 1;
+    }
+    int found = 0;
+    while (args && args.starts_with("--")) {
+        size_t i = long_flags.lower_bound(args.current());
+        found += i < long_flags.size() && long_flags[i].key == args.current();
+        args.pop();
+    }
+    arglet::remaining rest;
+    rest.parse(args);
+    return found + int(rest->size());
+}
+
+int parse_with_schema(int argc, char const** argv) {
+    schema options;
+    options.add("-v, --verbose");
+    options.add("-o, --output", option_kind::value);
+    options.add(tuplet::get<2>(flag_args));
+    if (!options.finalize()) {
+        return 1;
+    }
+    std::array<slot, 3> slots {};
+    arglet::arg_view args(argc, argv);
+    args.pop();
+    return options.parse(args, slots) ? int(slots[0].count) : 1;
+}
@@ -1,4 +1,8 @@
+#include <arglet/completion.hpp>
 #include <arglet/flags.hpp>
+#include <arglet/remaining.hpp>
+#include <arglet/schema.hpp>
+#include <arglet/utf8.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
@@ -52,3 +56,332 @@ TEST_CASE("Check that we can create flag maps") {
         }
     }
 }
+
+constexpr auto get_help_flags() {
+    using namespace arglet::flags;
+    return tuplet::tuple {
+        flag_arg<1, 1> {'v', "--version"},
+        flag_arg<2, 1> {{'h', '?'}, "--help"},
+        flag_arg<0, 2> {{}, {"--color", "--colour"}},
+        flag_arg<1, 0> {'g', {}},
+    };
+}
+
+TEST_CASE("Check that flag specs are parsed at compile time") {
+    using namespace arglet::flags;
+    using std::string_view_literals::operator""sv;
+
+    constexpr auto version = flag_spec<"-v, --version, --ver">;
+    STATIC_REQUIRE(std::is_same_v<decltype(version), flag_arg<1, 2> const>);
+    STATIC_REQUIRE(version.short_flags == std::array {'v'});
+    STATIC_REQUIRE(
+        version.long_flags == std::array {"--version"sv, "--ver"sv});
+
+    constexpr auto help = flag_spec<"-h,-?">;
+    STATIC_REQUIRE(help.short_flags == std::array {'h', '?'});
+    STATIC_REQUIRE(help.long_flags.empty());
+
+    constexpr auto color = flag_spec<"  --color ,\t--colour_mode  ">;
+    STATIC_REQUIRE(
+        color.long_flags == std::array {"--color"sv, "--colour_mode"sv});
+
+    // Specs feed directly into the flag maps
+    constexpr static auto tup = tuplet::tuple {version, help, color};
+    constexpr static auto short_args = make_short_flag_map(tup);
+    constexpr static auto long_args = make_long_flag_map(tup);
+    STATIC_REQUIRE(short_args.get_keys() == std::array {'?', 'h', 'v'});
+    STATIC_REQUIRE(
+        long_args.get_keys()
+        == std::array {
+            "--color"sv, "--colour_mode"sv, "--ver"sv, "--version"sv});
+}
+
+TEST_CASE("Check that help text is generated at compile time") {
+    using std::string_view_literals::operator""sv;
+
+    constexpr auto text = arglet::flags::help_text<get_help_flags>;
+    static_assert(
+        text
+        == "  -v, --version\n"
+           "  -h, -?, --help\n"
+           "  --color, --colour\n"
+           "  -g\n"sv);
+
+    REQUIRE(text.data()[text.size()] == '\0');
+}
+
+TEST_CASE("Check that completions are found from the flag maps") {
+    using namespace arglet::flags;
+    using std::string_view;
+    using std::string_view_literals::operator""sv;
+
+    constexpr static auto tup = tuplet::tuple {
+        flag_arg<1, 1> {'v', "--version"},
+        flag_arg<1, 1> {'c', "--color"},
+        flag_arg<0, 1> {{}, "--colour"},
+        flag_arg<1, 1> {'h', "--help"},
+        flag_arg<0, 1> {{}, "--config"},
+    };
+    constexpr static auto short_args = make_short_flag_map(tup);
+    constexpr static auto long_args = make_long_flag_map(tup);
+    constexpr static std::array commands {"build"sv, "check"sv, "clean"sv};
+
+    auto complete = [](string_view word, std::span<string_view const> cmds) {
+        char buffer[256];
+        arglet::util::text_writer out {buffer, 0, sizeof(buffer)};
+        arglet::completion::write_completions(
+            word, long_args, short_args, cmds, out);
+        return std::string(buffer, out.size);
+    };
+
+    REQUIRE(complete("--co", {}) == "--color\n--colour\n--config\n");
+    REQUIRE(complete("--colo", {}) == "--color\n--colour\n");
+    REQUIRE(complete("--h", commands) == "--help\n");
+    REQUIRE(complete("--x", commands) == "");
+    REQUIRE(complete("-v", commands) == "-v\n");
+    REQUIRE(complete("-x", commands) == "");
+    REQUIRE(
+        complete("-", {})
+        == "-c\n-h\n-v\n--color\n--colour\n--config\n--help\n--version\n");
+    REQUIRE(complete("", {}) == complete("-", {}));
+    REQUIRE(complete("c", commands) == "check\nclean\n");
+    REQUIRE(complete("", commands) == "build\ncheck\nclean\n");
+    REQUIRE(complete("z", commands) == "");
+
+    SECTION("Completions that don't fit are dropped whole") {
+        char buffer[12];
+        arglet::util::text_writer out {buffer, 0, sizeof(buffer)};
+        arglet::completion::write_completions(
+            "--co", long_args, short_args, {}, out);
+        // "--color\n--co" was written, but only "--color\n" is complete
+        REQUIRE(out.size > sizeof(buffer));
+        REQUIRE(arglet::completion::whole_lines_size(out) == 8);
+
+        arglet::util::text_writer tiny {buffer, 0, 4};
+        arglet::completion::write_completions(
+            "--co", long_args, short_args, {}, tiny);
+        REQUIRE(arglet::completion::whole_lines_size(tiny) == 0);
+    }
+
+    SECTION("Check that lower_bound finds the first key not less than arg") {
+        REQUIRE(long_args.lower_bound("--a") == 0);
+        REQUIRE(long_args.lower_bound("--color") == 0);
+        REQUIRE(long_args.lower_bound("--colp") == 2);
+        REQUIRE(long_args.lower_bound("--z") == long_args.size());
+    }
+}
+
+TEST_CASE("Check that remaining captures the rest of the arguments") {
+    using arglet::arg_view;
+    using arglet::remaining;
+    using std::string_view_literals::operator""sv;
+
+    char const* argv[] {"prog", "-v", "a.txt", "--", "-b.txt"};
+
+    // A token_range is two pointers, no matter how many arguments it holds
+    STATIC_REQUIRE(sizeof(arglet::token_range) == 2 * sizeof(char const**));
+    STATIC_REQUIRE(std::random_access_iterator<arglet::token_range::iterator>);
+
+    SECTION("Every argument after the current one is captured") {
+        arg_view args(5, argv);
+        args.pop();
+        args.pop();
+
+        remaining files;
+        REQUIRE(files.parse(args));
+        REQUIRE(args.empty());
+        REQUIRE(files->size() == 3);
+        REQUIRE(files->front() == "a.txt"sv);
+        REQUIRE(files->back() == "-b.txt"sv);
+
+        // Tokens view the arguments, rather than copying them
+        REQUIRE((*files)[0].data() == argv[2]);
+    }
+
+    SECTION("A leading -- is skipped, and flags after it are kept") {
+        arg_view args(5, argv);
+        for (int i = 0; i < 3; i++) {
+            args.pop();
+        }
+
+        remaining rest;
+        REQUIRE(rest.parse(args));
+        REQUIRE(rest->size() == 1);
+        for (auto token : *rest) {
+            REQUIRE(token == "-b.txt"sv);
+        }
+    }
+
+    SECTION("An empty arg_view gives an empty range") {
+        arg_view args(0, argv);
+        remaining rest;
+        REQUIRE(rest.parse(args));
+        REQUIRE(rest->empty());
+        REQUIRE(rest->begin() == rest->end());
+    }
+}
+
+TEST_CASE("Check that arguments are validated as UTF-8") {
+    using arglet::arg_view;
+    using std::string_view_literals::operator""sv;
+    namespace utf8 = arglet::utf8;
+
+    // Validation is usable in constant evaluation
+    STATIC_REQUIRE(utf8::is_valid("caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80"));
+    STATIC_REQUIRE(utf8::find_invalid("ab\xC0\x80") == 2);
+
+    SECTION("Malformed sequences are found") {
+        // Overlong encodings, surrogates, code points past U+10FFFF, stray
+        // continuation bytes, and truncated sequences
+        std::string_view invalid[] {
+            "\xC0\x80"sv,
+            "\xE0\x80\x80"sv,
+            "\xF0\x80\x80\x80"sv,
+            "\xED\xA0\x80"sv,
+            "\xF4\x90\x80\x80"sv,
+            "\xF5\x80\x80\x80"sv,
+            "\x80"sv,
+            "\xE2\x82"sv,
+            "\xFF"sv,
+        };
+        // Every case is checked at each offset in an argument long enough to
+        // take the SIMD path, including across the boundary of a block
+        for (std::string_view bad : invalid) {
+            for (size_t offset = 0; offset < 40; offset++) {
+                std::string arg(offset, 'x');
+                arg += bad;
+                arg += std::string(40 - offset, 'y');
+                REQUIRE(utf8::find_invalid(arg) == offset);
+            }
+        }
+    }
+
+    SECTION("Long valid arguments are accepted") {
+        std::string arg;
+        for (int i = 0; i < 20; i++) {
+            arg += "x\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";
+            REQUIRE(utf8::is_valid(arg));
+        }
+    }
+
+    char const* argv[] {"prog", "--name=\xC3\xA9", "a\xFF" "b", "c\xC0", "d"};
+
+    SECTION("The first invalid argument is reported") {
+        arg_view args(5, argv);
+        auto diag = utf8::validate(args);
+        REQUIRE(diag);
+        REQUIRE(diag.arg_index == 2);
+        REQUIRE(diag.char_offset == 1);
+        REQUIRE(diag.token.data() == argv[2]);
+        REQUIRE(diag.num_invalid == 2);
+        // Reporting leaves the arguments alone
+        REQUIRE(args.size() == 5);
+    }
+
+    SECTION("Rejecting drops the invalid arguments before parsing") {
+        arg_view args(5, argv);
+        args.pop();
+        auto diag = utf8::validate(args, utf8::policy::reject);
+        REQUIRE(diag.arg_index == 1);
+        REQUIRE(args.size() == 1);
+        REQUIRE(args.current() == "--name=\xC3\xA9"sv);
+    }
+
+    SECTION("Valid arguments give an empty diagnostic") {
+        arg_view args(2, argv);
+        auto diag = utf8::validate(args, utf8::policy::reject);
+        REQUIRE(!diag);
+        REQUIRE(diag.num_invalid == 0);
+        REQUIRE(args.size() == 2);
+    }
+}
+
+TEST_CASE("Check that a schema built at runtime parses flags") {
+    using arglet::arg_view;
+    using arglet::flags::option_kind;
+    using arglet::flags::schema;
+    using arglet::flags::slot;
+    using std::string_view_literals::operator""sv;
+
+    schema options;
+    size_t verbose = options.add("-v, --verbose");
+    size_t quiet = options.add("-q");
+    size_t output = options.add("-o, --output", option_kind::value);
+    // Flag args from flag_spec can be added alongside runtime specs
+    constexpr static auto level = arglet::flags::flag_spec<"-l, --level">;
+    size_t level_index = options.add(level, option_kind::value);
+    REQUIRE(options.size() == 4);
+    REQUIRE(options.finalize());
+
+    REQUIRE(options.find("--verbose") == verbose);
+    REQUIRE(options.find('o') == output);
+    REQUIRE(options.find("--level") == level_index);
+    REQUIRE(options.find("--nope") == schema::npos);
+    REQUIRE(options.find('x') == schema::npos);
+
+    std::vector<slot> slots(options.size());
+
+    SECTION("Flags, groups of short flags, and values are recorded") {
+        char const* argv[] {
+            "-vq", "--output=a.txt", "-l3", "-v", "--", "-file"};
+        arg_view args(6, argv);
+        REQUIRE(options.parse(args, slots));
+        REQUIRE(slots[verbose].count == 2);
+        REQUIRE(slots[quiet]);
+        REQUIRE(slots[output].value == "a.txt"sv);
+        REQUIRE(slots[level_index].value == "3"sv);
+        // "--" is consumed, and everything after it is left
+        REQUIRE(args.size() == 1);
+        REQUIRE(args.current() == "-file"sv);
+    }
+
+    SECTION("Values may be given as the next argument") {
+        char const* argv[] {"--output", "b.txt", "-o", "c.txt", "file"};
+        arg_view args(5, argv);
+        REQUIRE(options.parse(args, slots));
+        REQUIRE(slots[output].count == 2);
+        REQUIRE(slots[output].value.data() == argv[3]);
+        REQUIRE(args.current() == "file"sv);
+    }
+
+    SECTION("Parsing stops at an unrecognized flag or missing value") {
+        char const* argv[] {"-v", "--bogus", "--output"};
+        arg_view args(3, argv);
+        REQUIRE(!options.parse(args, slots));
+        REQUIRE(args.current() == "--bogus"sv);
+        args.pop();
+        REQUIRE(!options.parse(args, slots));
+        REQUIRE(args.current() == "--output"sv);
+    }
+
+    SECTION("A group of short flags that fails changes no slots") {
+        char const* argv[] {"-vqx", "-vo"};
+        arg_view args(2, argv);
+        REQUIRE(!options.parse(args, slots));
+        REQUIRE(args.current() == "-vqx"sv);
+        args.pop();
+        // -o is missing its value
+        REQUIRE(!options.parse(args, slots));
+        REQUIRE(args.current() == "-vo"sv);
+        REQUIRE(!slots[verbose]);
+        REQUIRE(!slots[quiet]);
+        REQUIRE(!slots[output]);
+    }
+
+    SECTION("Malformed specs and duplicate flags are rejected") {
+        schema bad;
+        REQUIRE(bad.add("verbose") == schema::npos);
+        REQUIRE(bad.add("-v, --") == schema::npos);
+        // An option needs at least one flag
+        REQUIRE(bad.add("") == schema::npos);
+        REQUIRE(bad.add(" ") == schema::npos);
+        REQUIRE(bad.add(arglet::flags::any_flag_arg()) == schema::npos);
+        REQUIRE(bad.add(arglet::flags::flag_arg<0, 0>()) == schema::npos);
+        REQUIRE(bad.size() == 0);
+        bad.add("-v, --verbose");
+        bad.add("--verbose");
+        REQUIRE(!bad.finalize());
+        arg_view args(0, nullptr);
+        REQUIRE(!bad.parse(args, slots));
+    }
+}